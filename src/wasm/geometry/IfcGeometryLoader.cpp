@@ -13,11 +13,25 @@
 namespace webifc::geometry
 {
 
-  IfcGeometryLoader::IfcGeometryLoader(const webifc::parsing::IfcLoader &loader, webifc::utility::LoaderErrorHandler &errorHandler,const webifc::schema::IfcSchemaManager &schemaManager, uint16_t circleSegments) 
+  IfcGeometryLoader::IfcGeometryLoader(const webifc::parsing::IfcLoader &loader, webifc::utility::LoaderErrorHandler &errorHandler,const webifc::schema::IfcSchemaManager &schemaManager, uint16_t circleSegments, const CurveTessellation &curveTessellation) 
     :_loader(loader),_errorHandler(errorHandler),_schemaManager(schemaManager), _relVoidRel(PopulateRelVoidsRelMap()), _relVoids(PopulateRelVoidsMap()), _relAggregates(PopulateRelAggregatesMap()), 
-    _styledItems(PopulateStyledItemMap()), _relMaterials(PopulateRelMaterialsMap()), _materialDefinitions(PopulateMaterialDefinitionsMap()), _circleSegments(circleSegments)
+    _styledItems(PopulateStyledItemMap()), _relMaterials(PopulateRelMaterialsMap()), _materialDefinitions(PopulateMaterialDefinitionsMap()), _circleSegments(circleSegments), _curveTessellation(curveTessellation)
   {
     ReadLinearScalingFactor();
+    // the tolerances come in metres and degrees, curves are sampled in file units and radians
+    _curveTessellation.maxDeviation /= _linearScalingFactor;
+    _curveTessellation.maxAngle = glm::radians(_curveTessellation.maxAngle);
+  }
+
+  uint16_t IfcGeometryLoader::GetCircleSegments(double radius, double angleRad) const
+  {
+    return GetArcSegments(radius, angleRad, _circleSegments, _curveTessellation);
+  }
+
+  // in file units and radians
+  const CurveTessellation &IfcGeometryLoader::GetCurveTessellation() const
+  {
+    return _curveTessellation;
   }
 
 
@@ -241,7 +255,7 @@ namespace webifc::geometry
           ifcStartDirection = ifcStartDirection - (CONST_PI / 2);
 
           bool sw = true;
-          auto curve2D = GetEllipseCurve(StartRadiusOfCurvature, StartRadiusOfCurvature, 20, glm::dmat3(1), ifcStartDirection, ifcStartDirection + span, sw);
+          auto curve2D = GetEllipseCurve(StartRadiusOfCurvature, StartRadiusOfCurvature, GetArcSegments(StartRadiusOfCurvature, span, 20, _curveTessellation), glm::dmat3(1), ifcStartDirection, ifcStartDirection + span, sw);
           glm::dvec2 desp = glm::dvec2(StartPoint.x - curve2D.points[0].x, StartPoint.y - curve2D.points[0].y);
 
           for (size_t i=0; i < curve2D.points.size();i++)
@@ -447,7 +461,7 @@ namespace webifc::geometry
             ifcStartDirection = ifcStartDirection + CONST_PI;
             ifcEndDirection = ifcEndDirection + CONST_PI;
           }
-          auto curve2D = GetEllipseCurve(RadiusOfCurvature, RadiusOfCurvature, _circleSegments, glm::dmat3(1), ifcStartDirection, ifcEndDirection, sw);
+          auto curve2D = GetEllipseCurve(RadiusOfCurvature, RadiusOfCurvature, GetCircleSegments(RadiusOfCurvature, ifcEndDirection - ifcStartDirection), glm::dmat3(1), ifcStartDirection, ifcEndDirection, sw);
           glm::dvec2 desp = glm::dvec2(StartPoint.x - curve2D.points[0].x, StartPoint.y - curve2D.points[0].y);
 
           for (size_t i=0; i < curve2D.points.size();i++)
@@ -540,7 +554,7 @@ namespace webifc::geometry
         auto outputColor = GetColor(_loader.GetRefArgument());
         _loader.MoveToArgumentOffset(line, 1);
 
-        if (_loader.GetTokenType() == parsing::IfcTokenType::REAL)
+        if (parsing::IsNumber(_loader.GetTokenType()))
         {
           _loader.StepBack();
           outputColor.value().a = 1 - _loader.GetDoubleArgument();
@@ -1006,24 +1020,8 @@ namespace webifc::geometry
     auto lineID = _loader.ExpressIDToLineID(expressID);
     auto &line = _loader.GetLine(lineID);
 
-    _loader.MoveToArgumentOffset(line, 0);
-
     std::vector<glm::dvec3> result;
-
-    _loader.GetTokenType();
-
-    // while we have point set begin
-    while (_loader.GetTokenType() == parsing::IfcTokenType::SET_BEGIN)
-    {
-      // because these calls cannot be reordered we have to use intermediate variables
-      double x = _loader.GetDoubleArgument();
-      double y = _loader.GetDoubleArgument();
-      double z = _loader.GetDoubleArgument();
-      result.emplace_back(x, y, z);
-
-      // read point set end
-      _loader.GetTokenType();
-    }
+    _loader.ReadNumberTuples<double>(line, 0, 3, result);
 
     return result;
   }
@@ -1033,23 +1031,8 @@ namespace webifc::geometry
     auto lineID = _loader.ExpressIDToLineID(expressID);
     auto &line = _loader.GetLine(lineID);
 
-    _loader.MoveToArgumentOffset(line, 0);
-
     std::vector<glm::dvec2> result;
-
-    _loader.GetTokenType();
-
-    // while we have point set begin
-    while (_loader.GetTokenType() == parsing::IfcTokenType::SET_BEGIN)
-    {
-      // because these calls cannot be reordered we have to use intermediate variables
-      double x = _loader.GetDoubleArgument();
-      double y = _loader.GetDoubleArgument();
-      result.emplace_back(x, y);
-
-      // read point set end
-      _loader.GetTokenType();
-    }
+    _loader.ReadNumberTuples<double>(line, 0, 2, result);
 
     return result;
   }
@@ -1274,7 +1257,9 @@ namespace webifc::geometry
               if (sg.type == "IFCARCINDEX")
               {
                 auto pts = ReadIfcCartesianPointList2D(pts2DRef);
-                IfcCurve arc = BuildArc3Pt(pts[sg.indexs[0] - 1], pts[sg.indexs[1] - 1], pts[sg.indexs[2] - 1],_circleSegments);
+                double radius, sweep;
+                GetArc3PtExtent(pts[sg.indexs[0] - 1], pts[sg.indexs[1] - 1], pts[sg.indexs[2] - 1], radius, sweep);
+                IfcCurve arc = BuildArc3Pt(pts[sg.indexs[0] - 1], pts[sg.indexs[1] - 1], pts[sg.indexs[2] - 1], GetCircleSegments(radius, sweep));
                 for (auto &pt : arc.points)
                 {
                   curve.Add(pt);
@@ -1382,9 +1367,10 @@ namespace webifc::geometry
 
         size_t startIndex = curve.points.size();
 
-        for (int i = 0; i < _circleSegments; i++)
+        uint16_t circleSegments = GetCircleSegments(radius, lengthRad);
+        for (int i = 0; i < circleSegments; i++)
         {
-          double ratio = static_cast<double>(i) / (_circleSegments - 1);
+          double ratio = static_cast<double>(i) / (circleSegments - 1);
           double angle = startRad + ratio * lengthRad;
 
           if (sameSense == 0)
@@ -1510,10 +1496,10 @@ namespace webifc::geometry
 
         size_t startIndex = curve.points.size();
 
-
-        for (int i = 0; i < _circleSegments; i++)
+        uint16_t circleSegments = GetCircleSegments(std::max(std::abs(radius1), std::abs(radius2)), lengthRad);
+        for (int i = 0; i < circleSegments; i++)
         {
-          double ratio = static_cast<double>(i) / (_circleSegments - 1);
+          double ratio = static_cast<double>(i) / (circleSegments - 1);
           double angle = startRad + ratio * lengthRad;
           if (sameSense == 0)
           {
@@ -1591,7 +1577,7 @@ namespace webifc::geometry
             ctrolPts.push_back(GetCartesianPoint2D(pointId));
           }
         
-          std::vector<glm::dvec2> tempPoints = GetRationalBSplineCurveWithKnots(degree, ctrolPts, knots, weights);
+          std::vector<glm::dvec2> tempPoints = GetRationalBSplineCurveWithKnots(degree, ctrolPts, knots, weights, _curveTessellation);
           for (size_t i = 0; i < tempPoints.size(); i++) curve.Add(tempPoints[i]);
         } else if (dimensions == 3) {
           std::vector<glm::dvec3> ctrolPts;
@@ -1601,7 +1587,7 @@ namespace webifc::geometry
             ctrolPts.push_back(GetCartesianPoint3D(pointId));
           }
         
-          std::vector<glm::dvec3> tempPoints = GetRationalBSplineCurveWithKnots(degree, ctrolPts, knots, weights);
+          std::vector<glm::dvec3> tempPoints = GetRationalBSplineCurveWithKnots(degree, ctrolPts, knots, weights, _curveTessellation);
           for (size_t i = 0; i < tempPoints.size(); i++) curve.Add(tempPoints[i]);
         }        
 
@@ -1680,7 +1666,7 @@ namespace webifc::geometry
             uint32_t pointId = _loader.GetRefArgument(token);
             ctrolPts.push_back(GetCartesianPoint3D(pointId));
           }
-          std::vector<glm::dvec2> tempPoints = GetRationalBSplineCurveWithKnots(degree, ctrolPts, knots, weights);
+          std::vector<glm::dvec2> tempPoints = GetRationalBSplineCurveWithKnots(degree, ctrolPts, knots, weights, _curveTessellation);
           for (size_t i = 0; i < tempPoints.size(); i++) curve.Add(tempPoints[i]);
         } 
       else if (dimensions == 3)
@@ -1691,7 +1677,7 @@ namespace webifc::geometry
           uint32_t pointId = _loader.GetRefArgument(token);
           ctrolPts.push_back(GetCartesianPoint3D(pointId));
         }
-        std::vector<glm::dvec3> tempPoints = GetRationalBSplineCurveWithKnots(degree, ctrolPts, knots, weights);
+        std::vector<glm::dvec3> tempPoints = GetRationalBSplineCurveWithKnots(degree, ctrolPts, knots, weights, _curveTessellation);
         for (size_t i = 0; i < tempPoints.size(); i++) curve.Add(tempPoints[i]);
       }
 
@@ -1764,7 +1750,7 @@ case schema::IFCRATIONALBSPLINECURVEWITHKNOTS:
             ctrolPts.push_back(GetCartesianPoint3D(pointId));
           }
 
-          std::vector<glm::dvec2> tempPoints = GetRationalBSplineCurveWithKnots(degree, ctrolPts, knots, weights);
+          std::vector<glm::dvec2> tempPoints = GetRationalBSplineCurveWithKnots(degree, ctrolPts, knots, weights, _curveTessellation);
           for (size_t i = 0; i < tempPoints.size(); i++) curve.Add(tempPoints[i]);
         }
       else if (dimensions == 3)
@@ -1776,7 +1762,7 @@ case schema::IFCRATIONALBSPLINECURVEWITHKNOTS:
           ctrolPts.push_back(GetCartesianPoint3D(pointId));
         }
 
-        std::vector<glm::dvec3> tempPoints = GetRationalBSplineCurveWithKnots(degree, ctrolPts, knots, weights);
+        std::vector<glm::dvec3> tempPoints = GetRationalBSplineCurveWithKnots(degree, ctrolPts, knots, weights, _curveTessellation);
         for (size_t i = 0; i < tempPoints.size(); i++) curve.Add(tempPoints[i]);
       }
 
@@ -1802,7 +1788,35 @@ default:
 }
 
 
-IfcProfile IfcGeometryLoader::GetProfile(uint32_t expressID) const
+size_t EstimateProfileMemory(const IfcProfile &profile)
+{
+  size_t size = sizeof(IfcProfile) + profile.curve.points.size() * sizeof(glm::dvec3) + profile.curve.indices.size() * sizeof(uint16_t);
+  for (auto &hole : profile.holes) size += sizeof(IfcCurve) + hole.points.size() * sizeof(glm::dvec3) + hole.indices.size() * sizeof(uint16_t);
+  for (auto &child : profile.profiles) size += EstimateProfileMemory(child);
+  return size;
+}
+
+std::shared_ptr<const IfcProfile> IfcGeometryLoader::GetProfile(uint32_t expressID) const
+{
+  // members of the same section share their profile, the tessellated curves are kept and handed out read only
+  uint64_t key = (static_cast<uint64_t>(expressID) << 16) | _circleSegments;
+  auto it = _profileCache.find(key);
+  if (it != _profileCache.end()) return it->second;
+
+  auto profile = std::make_shared<const IfcProfile>(ComputeProfile(expressID));
+  size_t size = EstimateProfileMemory(*profile);
+  if (_profileCacheSize + size > PROFILE_CACHE_MEMORY_LIMIT)
+  {
+    // profiles are cheap compared to the geometry built from them, starting over is good enough
+    _profileCache.clear();
+    _profileCacheSize = 0;
+  }
+  _profileCache.emplace(key, profile);
+  _profileCacheSize += size;
+  return profile;
+}
+
+IfcProfile IfcGeometryLoader::ComputeProfile(uint32_t expressID) const
 {
   auto profile = GetProfileByLine(_loader.ExpressIDToLineID(expressID));
 
@@ -1952,7 +1966,7 @@ IfcProfile IfcGeometryLoader::GetProfileByLine(uint32_t lineID) const
         placement = GetAxis2Placement2D(placementID);
       }
 
-      profile.curve = GetCircleCurve(radius, _circleSegments, placement);
+      profile.curve = GetCircleCurve(radius, GetCircleSegments(radius, 2 * CONST_PI), placement);
 
       return profile;
     }
@@ -1971,7 +1985,7 @@ IfcProfile IfcGeometryLoader::GetProfileByLine(uint32_t lineID) const
 
       glm::dmat3 placement = GetAxis2Placement2D(placementID);
 
-      profile.curve = GetEllipseCurve(radiusX, radiusY, _circleSegments, placement);
+      profile.curve = GetEllipseCurve(radiusX, radiusY, GetCircleSegments(std::max(std::abs(radiusX), std::abs(radiusY)), 2 * CONST_PI), placement);
 
       return profile;
     }
@@ -1990,8 +2004,8 @@ IfcProfile IfcGeometryLoader::GetProfileByLine(uint32_t lineID) const
 
       glm::dmat3 placement = GetAxis2Placement2D(placementID);
 
-      profile.curve = GetCircleCurve(radius, _circleSegments, placement);
-      profile.holes.push_back(GetCircleCurve(radius - thickness, _circleSegments, placement));
+      profile.curve = GetCircleCurve(radius, GetCircleSegments(radius, 2 * CONST_PI), placement);
+      profile.holes.push_back(GetCircleCurve(radius - thickness, GetCircleSegments(radius - thickness, 2 * CONST_PI), placement));
       std::reverse(profile.holes[0].points.begin(), profile.holes[0].points.end());
 
       return profile;
@@ -2026,7 +2040,7 @@ IfcProfile IfcGeometryLoader::GetProfileByLine(uint32_t lineID) const
         // optional fillet
       bool hasFillet = false;
       double filletRadius = 0;
-      if (_loader.GetTokenType() == parsing::IfcTokenType::REAL)
+      if (parsing::IsNumber(_loader.GetTokenType()))
       {
         _loader.StepBack();
 
@@ -2074,7 +2088,7 @@ IfcProfile IfcGeometryLoader::GetProfileByLine(uint32_t lineID) const
         // optional fillet
       bool hasFillet = false;
 
-      if (_loader.GetTokenType() == parsing::IfcTokenType::REAL)
+      if (parsing::IsNumber(_loader.GetTokenType()))
       {
         _loader.StepBack();
 
@@ -2123,7 +2137,7 @@ IfcProfile IfcGeometryLoader::GetProfileByLine(uint32_t lineID) const
         // optional fillet
       bool hasFillet = false;
 
-      if (_loader.GetTokenType() == parsing::IfcTokenType::REAL)
+      if (parsing::IsNumber(_loader.GetTokenType()))
       {
         _loader.StepBack();
 
@@ -2412,7 +2426,7 @@ glm::dmat3 IfcGeometryLoader::GetAxis2Placement2D(uint32_t expressID) const
       glm::dvec2 pos = GetCartesianPoint2D(posID);
 
       _loader.MoveToArgumentOffset(line, 3);
-      if (_loader.GetTokenType() == parsing::IfcTokenType::REAL)
+      if (parsing::IsNumber(_loader.GetTokenType()))
       {
         _loader.StepBack();
         scale1 = _loader.GetDoubleArgument();
@@ -2421,7 +2435,7 @@ glm::dmat3 IfcGeometryLoader::GetAxis2Placement2D(uint32_t expressID) const
       if (line.ifcType == schema::IFCCARTESIANTRANSFORMATIONOPERATOR2DNONUNIFORM)
       {
         _loader.MoveToArgumentOffset(line, 4);
-        if (_loader.GetTokenType() == parsing::IfcTokenType::REAL)
+        if (parsing::IsNumber(_loader.GetTokenType()))
         {
           _loader.StepBack();
           scale2 = _loader.GetDoubleArgument();
@@ -2446,6 +2460,23 @@ glm::dmat3 IfcGeometryLoader::GetAxis2Placement2D(uint32_t expressID) const
 }
 
 glm::dmat4 IfcGeometryLoader::GetLocalPlacement(uint32_t expressID) const
+{
+  // elements share long IfcLocalPlacement chains (site, building, storey), so every resolved placement is kept
+  auto it = _localPlacementCache.find(expressID);
+  if (it != _localPlacementCache.end()) return it->second;
+  glm::dmat4 placement = ComputeLocalPlacement(expressID);
+  _localPlacementCache.emplace(expressID, placement);
+  return placement;
+}
+
+void IfcGeometryLoader::ClearCaches() const
+{
+  _localPlacementCache.clear();
+  _profileCache.clear();
+  _profileCacheSize = 0;
+}
+
+glm::dmat4 IfcGeometryLoader::ComputeLocalPlacement(uint32_t expressID) const
 {
   uint32_t lineID = _loader.ExpressIDToLineID(expressID);
   auto &line = _loader.GetLine(lineID);
@@ -2561,7 +2592,7 @@ glm::dmat4 IfcGeometryLoader::GetLocalPlacement(uint32_t expressID) const
       glm::dvec3 pos = GetCartesianPoint3D(posID);
 
       _loader.MoveToArgumentOffset(line, 3);
-      if (_loader.GetTokenType() == parsing::IfcTokenType::REAL)
+      if (parsing::IsNumber(_loader.GetTokenType()))
       {
         _loader.StepBack();
         scale1 = _loader.GetDoubleArgument();
@@ -2577,14 +2608,14 @@ glm::dmat4 IfcGeometryLoader::GetLocalPlacement(uint32_t expressID) const
       if (line.ifcType == schema::IFCCARTESIANTRANSFORMATIONOPERATOR3DNONUNIFORM)
       {
         _loader.MoveToArgumentOffset(line, 5);
-        if (_loader.GetTokenType() == parsing::IfcTokenType::REAL)
+        if (parsing::IsNumber(_loader.GetTokenType()))
         {
           _loader.StepBack();
           scale2 = _loader.GetDoubleArgument();
         }
 
         _loader.MoveToArgumentOffset(line, 6);
-        if (_loader.GetTokenType() == parsing::IfcTokenType::REAL)
+        if (parsing::IsNumber(_loader.GetTokenType()))
         {
           _loader.StepBack();
           scale3 = _loader.GetDoubleArgument();
@@ -2981,11 +3012,11 @@ std::vector<IfcSegmentIndexSelect> IfcGeometryLoader::ReadCurveIndices() const
         {
           _loader.StepBack();
           t = _loader.GetTokenType();
-              // If you receive a real then add the real to the list
-          if (t == parsing::IfcTokenType::REAL)
+              // If you receive a number then add it to the list
+          if (parsing::IsNumber(t))
           {
             _loader.StepBack();
-            segment.indexs.push_back(static_cast<uint32_t>(_loader.GetDoubleArgument()));
+            segment.indexs.push_back(static_cast<uint32_t>(_loader.GetIntArgument()));
           }
         }
       }
@@ -6,6 +6,7 @@
 
 #include <unordered_map>
 #include <vector>
+#include <memory>
 #include <optional>
 #include <glm/glm.hpp>
 
@@ -24,14 +25,14 @@ namespace webifc::geometry
   class IfcGeometryLoader 
   {
   public:
-    IfcGeometryLoader(const webifc::parsing::IfcLoader &loader, webifc::utility::LoaderErrorHandler &errorHandler,const webifc::schema::IfcSchemaManager &schemaManager,uint16_t circleSegments);
+    IfcGeometryLoader(const webifc::parsing::IfcLoader &loader, webifc::utility::LoaderErrorHandler &errorHandler,const webifc::schema::IfcSchemaManager &schemaManager,uint16_t circleSegments, const CurveTessellation &curveTessellation = {});
     std::array<glm::dvec3,2> GetAxis1Placement(const uint32_t expressID) const;
     glm::dmat3 GetAxis2Placement2D(const uint32_t expressID) const;
     glm::dmat4 GetLocalPlacement(const uint32_t expressID) const;
     glm::dvec3 GetCartesianPoint3D(const uint32_t expressID) const;
     glm::dvec2 GetCartesianPoint2D(const uint32_t expressID) const;
     glm::dvec3 GetVector(const uint32_t expressID) const;
-    IfcProfile GetProfile(uint32_t expressID) const;
+    std::shared_ptr<const IfcProfile> GetProfile(uint32_t expressID) const;
     IfcProfile3D GetProfile3D(uint32_t expressID) const;
     IfcCurve GetCurve(uint32_t expressID,uint8_t dimensions, bool edge=false) const;
     std::vector<glm::dvec3> ReadIfcCartesianPointList3D(const uint32_t expressID) const;
@@ -50,7 +51,12 @@ namespace webifc::geometry
     const std::unordered_map<uint32_t, std::vector<std::pair<uint32_t, uint32_t>>> &GetRelMaterials() const;
     const std::unordered_map<uint32_t, std::vector<std::pair<uint32_t, uint32_t>>> &GetMaterialDefinitions() const;
     double GetLinearScalingFactor() const;
+    uint16_t GetCircleSegments(double radius, double angleRad) const;
+    const CurveTessellation &GetCurveTessellation() const;
+    void ClearCaches() const;
   private:
+    glm::dmat4 ComputeLocalPlacement(const uint32_t expressID) const;
+    IfcProfile ComputeProfile(uint32_t expressID) const;
     IfcCurve GetAlignmentCurve(uint32_t expressID) const;
     IfcProfile GetProfileByLine(uint32_t lineID) const;
     IfcTrimmingSelect GetTrimSelect(uint32_t DIM, std::vector<uint32_t> &tapeOffsets) const;
@@ -70,6 +76,11 @@ namespace webifc::geometry
     double _cubicScalingFactor = 1;
     double _angularScalingFactor = 1;
     uint16_t _circleSegments;
+    CurveTessellation _curveTessellation;
+    mutable std::unordered_map<uint32_t, glm::dmat4> _localPlacementCache;
+    static constexpr size_t PROFILE_CACHE_MEMORY_LIMIT = 64 * 1024 * 1024;
+    mutable std::unordered_map<uint64_t, std::shared_ptr<const IfcProfile>> _profileCache;
+    mutable size_t _profileCacheSize = 0;
     std::unordered_map<uint32_t, std::vector<uint32_t>> PopulateRelVoidsMap();
     std::unordered_map<uint32_t, std::vector<uint32_t>> PopulateRelVoidsRelMap();
     std::unordered_map<uint32_t, std::vector<uint32_t>> PopulateRelAggregatesMap();
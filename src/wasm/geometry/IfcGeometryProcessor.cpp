@@ -13,15 +13,30 @@
 #include "operations/curve-utils.h"
 #include "operations/mesh_utils.h"
 #include "fuzzy/fuzzy-bools.h"
+#include "../utility/ScratchArena.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <utility>
 
 
 namespace webifc::geometry
 {
-    IfcGeometryProcessor::IfcGeometryProcessor(const webifc::parsing::IfcLoader &loader, webifc::utility::LoaderErrorHandler &errorHandler,const webifc::schema::IfcSchemaManager &schemaManager,uint16_t circleSegments, bool coordinateToOrigin)
-    :  _geometryLoader(loader, errorHandler,schemaManager,circleSegments), _loader(loader), _errorHandler(errorHandler), _schemaManager(schemaManager), _coordinateToOrigin(coordinateToOrigin), _circleSegments(circleSegments)
+    IfcGeometryProcessor::IfcGeometryProcessor(const webifc::parsing::IfcLoader &loader, webifc::utility::LoaderErrorHandler &errorHandler,const webifc::schema::IfcSchemaManager &schemaManager,const webifc::utility::LoaderSettings &settings, uint32_t brepThreads)
+    :  _geometryLoader(loader, errorHandler,schemaManager,settings.CIRCLE_SEGMENTS_HIGH,{settings.CURVE_MAX_DEVIATION,settings.CURVE_MAX_ANGLE,(uint16_t)settings.CURVE_MIN_SEGMENTS,(uint16_t)settings.CURVE_MAX_SEGMENTS}), _loader(loader), _errorHandler(errorHandler), _schemaManager(schemaManager), _coordinateToOrigin(settings.COORDINATE_TO_ORIGIN), _representationCacheLimit(settings.GEOMETRY_CACHE_SIZE), _boolAbortThreshold(settings.BOOL_ABORT_THRESHOLD), _boolTimeBudget(settings.BOOL_TIME_BUDGET), _boolMergeOperands(settings.BOOL_MERGE_OPERANDS), _creaseAngle(glm::radians(settings.CREASE_ANGLE)), _brepParallelFaces(settings.BREP_PARALLEL_FACES), _brepThreads(std::max<uint32_t>(1, brepThreads))
     {}
 
-    IfcGeometryLoader IfcGeometryProcessor::GetLoader() const
+    // takes over geometry produced by another processor, e.g. one meshing on a worker thread
+    void IfcGeometryProcessor::SetGeometry(uint32_t expressID, IfcGeometry &&geometry)
+    {
+        _expressIDToGeometry[expressID] = std::move(geometry);
+    }
+
+    const IfcGeometryLoader &IfcGeometryProcessor::GetLoader() const
     {
         return _geometryLoader;
     }   
@@ -31,6 +46,11 @@ namespace webifc::geometry
         _transformation = val;
     }
 
+    glm::dmat4 IfcGeometryProcessor::GetTransformation() const
+    {
+        return _transformation;
+    }
+
     IfcGeometry &IfcGeometryProcessor::GetGeometry(uint32_t expressID)
     {
         return _expressIDToGeometry[expressID];
@@ -41,10 +61,81 @@ namespace webifc::geometry
         _expressIDToGeometry = {};
     }
 
+    // drops everything derived from line contents, to be called when lines are written
+    void IfcGeometryProcessor::ClearCaches()
+    {
+        _geometryLoader.ClearCaches();
+        _representationCache.clear();
+        _representationLRU.clear();
+        _representationCacheSize = 0;
+    }
+
+    size_t EstimateGeometryMemory(const IfcGeometry &geometry)
+    {
+        size_t size = sizeof(IfcGeometry) + geometry.vertexData.size() * sizeof(double) + geometry.indexData.size() * sizeof(uint32_t);
+        for (auto &component : geometry.components) size += EstimateGeometryMemory(component);
+        return size;
+    }
+
+    void CollectGeometryIDs(const IfcComposedMesh &mesh, std::vector<uint32_t> &ids)
+    {
+        if (mesh.hasGeometry) ids.push_back(mesh.expressID);
+        for (auto &child : mesh.children) CollectGeometryIDs(child, ids);
+    }
+
+    void IfcGeometryProcessor::CacheRepresentation(uint32_t expressID, const IfcComposedMesh &mesh)
+    {
+        if (_representationCacheLimit == 0) return;
+
+        CachedRepresentation cached;
+        cached.mesh = mesh;
+        cached.size = 0;
+        std::vector<uint32_t> ids;
+        CollectGeometryIDs(mesh, ids);
+        for (uint32_t id : ids)
+        {
+            auto &geometry = _expressIDToGeometry[id];
+            cached.size += EstimateGeometryMemory(geometry);
+            cached.geometries.emplace(id, geometry);
+        }
+        if (cached.size > _representationCacheLimit) return;
+
+        while (_representationCacheSize + cached.size > _representationCacheLimit)
+        {
+            auto evicted = _representationCache.find(_representationLRU.back());
+            _representationCacheSize -= evicted->second.size;
+            _representationCache.erase(evicted);
+            _representationLRU.pop_back();
+        }
+
+        _representationLRU.push_front(expressID);
+        cached.lruPosition = _representationLRU.begin();
+        _representationCacheSize += cached.size;
+        _representationCache.emplace(expressID, std::move(cached));
+    }
+
+    bool IfcGeometryProcessor::RestoreRepresentation(uint32_t expressID, IfcComposedMesh &mesh)
+    {
+        auto it = _representationCache.find(expressID);
+        if (it == _representationCache.end()) return false;
+
+        auto &cached = it->second;
+        _representationLRU.splice(_representationLRU.begin(), _representationLRU, cached.lruPosition);
+        // copies, the flat mesh step normalizes and may reverse them per placement
+        for (auto &[id, geometry] : cached.geometries) _expressIDToGeometry[id] = geometry;
+        mesh = cached.mesh;
+        return true;
+    }
+
     fuzzybools::Geometry IfcGeometryProcessor::GeomToFBGeom(const IfcGeometry& geom)
     {
         fuzzybools::Geometry fbGeom;
+        AddGeomToFBGeom(geom, fbGeom);
+        return fbGeom;
+    }
 
+    void IfcGeometryProcessor::AddGeomToFBGeom(const IfcGeometry& geom, fuzzybools::Geometry& fbGeom)
+    {
         for (size_t i = 0; i < geom.numFaces; i++)
         {
             const Face& f = geom.GetFace(i);
@@ -55,8 +146,6 @@ namespace webifc::geometry
 
             fbGeom.AddFace(a, b, c);
         }
-
-        return fbGeom;
     }
 
     IfcGeometry IfcGeometryProcessor::FBGeomToGeom(const fuzzybools::Geometry& fbGeom)
@@ -83,6 +172,41 @@ namespace webifc::geometry
         return _coordinationMatrix;
     }
 
+    void IfcGeometryProcessor::SetCoordinationMatrix(const glm::dmat4 &val)
+    {
+        _coordinationMatrix = val;
+        _isCoordinated = true;
+    }
+
+    static constexpr size_t SLOWEST_BOOLS_REPORTED = 32;
+
+    // the slowest BoolSubtract calls so far, slowest first, including the aborted ones
+    const std::vector<BoolTiming> &IfcGeometryProcessor::GetSlowestBools() const
+    {
+        return _slowestBools;
+    }
+
+    void IfcGeometryProcessor::AddBoolTimings(const std::vector<BoolTiming> &timings)
+    {
+        for (auto &timing : timings)
+        {
+            auto position = std::upper_bound(_slowestBools.begin(), _slowestBools.end(), timing, [](const BoolTiming &a, const BoolTiming &b) { return a.milliseconds > b.milliseconds; });
+            _slowestBools.insert(position, timing);
+        }
+        if (_slowestBools.size() > SLOWEST_BOOLS_REPORTED) _slowestBools.resize(SLOWEST_BOOLS_REPORTED);
+    }
+
+    // hands the timings over to the caller, e.g. to merge them into another processor, and starts a new list
+    std::vector<BoolTiming> IfcGeometryProcessor::TakeSlowestBools()
+    {
+        return std::exchange(_slowestBools, {});
+    }
+
+    bool IfcGeometryProcessor::IsCoordinated() const
+    {
+        return _isCoordinated;
+    }
+
     IfcComposedMesh IfcGeometryProcessor::GetMeshByLine(uint32_t lineID)
     {
         auto &line = _loader.GetLine(lineID);
@@ -259,15 +383,20 @@ namespace webifc::geometry
                     uint32_t secondOperandID = _loader.GetRefArgument();
 
                     auto firstMesh = GetMesh(firstOperandID);
-                    auto secondMesh = GetMesh(secondOperandID);
 
                     auto origin = GetOrigin(firstMesh, _expressIDToGeometry);
                     auto normalizeMat = glm::translate(-origin);
 
                     auto flatFirstMeshes = flatten(firstMesh, _expressIDToGeometry, normalizeMat);
-                    auto flatSecondMeshes = flatten(secondMesh, _expressIDToGeometry, normalizeMat);
 
-                    IfcGeometry resultMesh = BoolSubtract(flatFirstMeshes, flatSecondMeshes, line.expressID);
+                    IfcGeometry resultMesh;
+                    if (!ClipByHalfSpace(flatFirstMeshes, secondOperandID, normalizeMat, resultMesh))
+                    {
+                        auto secondMesh = GetMesh(secondOperandID);
+                        auto flatSecondMeshes = flatten(secondMesh, _expressIDToGeometry, normalizeMat);
+
+                        resultMesh = BoolSubtract(flatFirstMeshes, flatSecondMeshes, line.expressID);
+                    }
 
                     _expressIDToGeometry[line.expressID] = resultMesh;
                     mesh.hasGeometry = true;
@@ -298,13 +427,11 @@ namespace webifc::geometry
                     uint32_t secondOperandID = _loader.GetRefArgument();
 
                     auto firstMesh = GetMesh(firstOperandID);
-                    auto secondMesh = GetMesh(secondOperandID);
 
                     auto origin = GetOrigin(firstMesh, _expressIDToGeometry);
                     auto normalizeMat = glm::translate(-origin);
 
                     auto flatFirstMeshes = flatten(firstMesh, _expressIDToGeometry, normalizeMat);
-                    auto flatSecondMeshes = flatten(secondMesh, _expressIDToGeometry, normalizeMat);
 
                     if (flatFirstMeshes.size() == 0)
                     {
@@ -313,7 +440,14 @@ namespace webifc::geometry
                         return mesh;
                     }
 
-                    IfcGeometry resultMesh = BoolSubtract(flatFirstMeshes, flatSecondMeshes, line.expressID);
+                    IfcGeometry resultMesh;
+                    if (!ClipByHalfSpace(flatFirstMeshes, secondOperandID, normalizeMat, resultMesh))
+                    {
+                        auto secondMesh = GetMesh(secondOperandID);
+                        auto flatSecondMeshes = flatten(secondMesh, _expressIDToGeometry, normalizeMat);
+
+                        resultMesh = BoolSubtract(flatFirstMeshes, flatSecondMeshes, line.expressID);
+                    }
 
                     _expressIDToGeometry[line.expressID] = resultMesh;
                     mesh.hasGeometry = true;
@@ -441,6 +575,11 @@ namespace webifc::geometry
                 }
             case schema::IFCREPRESENTATIONMAP:
                 {
+                    if (RestoreRepresentation(line.expressID, mesh))
+                    {
+                        return mesh;
+                    }
+
                     _loader.MoveToArgumentOffset(line, 0);
                     uint32_t axis2Placement = _loader.GetRefArgument();
                     uint32_t ifcPresentation = _loader.GetRefArgument();
@@ -448,6 +587,7 @@ namespace webifc::geometry
                     mesh.transformation = _geometryLoader.GetLocalPlacement(axis2Placement);
                     mesh.children.push_back(GetMesh(ifcPresentation));
 
+                    CacheRepresentation(line.expressID, mesh);
                     return mesh;
                 }
             case schema::IFCFACEBASEDSURFACEMODEL:
@@ -573,30 +713,34 @@ namespace webifc::geometry
                     // third argument closed, ignored
 
                     // indices
-                    _loader.MoveToArgumentOffset(line, 3);
-                    auto indices = Read2DArrayOfThreeIndices();
-
-                    IfcGeometry geom;
+                    auto indices = Read2DArrayOfThreeIndices(line, 3);
 
+                    // with a PnIndex the coordinate indices point into it instead of into the point list
+                    std::vector<uint32_t> pnIndex;
                     _loader.MoveToArgumentOffset(line, 4);
                     if (_loader.GetTokenType() == parsing::IfcTokenType::SET_BEGIN)
                     {
-                        _loader.StepBack();
-                        auto pnIndex = Read2DArrayOfThreeIndices();
-
-                        // ignore
-                        // std::cout << "Unsupported IFCTRIANGULATEDFACESET with PnIndex!" << std::endl;
+                        while (_loader.GetTokenType() != parsing::IfcTokenType::SET_END)
+                        {
+                            _loader.StepBack();
+                            pnIndex.push_back(static_cast<uint32_t>(_loader.GetIntArgument()));
+                        }
                     }
 
-                    for (size_t i = 0; i < indices.size(); i += 3)
+                    // one based in the file, out of range indices are dropped with their face
+                    for (auto &index : indices)
                     {
-                        int i1 = indices[i + 0] - 1;
-                        int i2 = indices[i + 1] - 1;
-                        int i3 = indices[i + 2] - 1;
-
-                        geom.AddFace(points[i1], points[i2], points[i3]);
+                        if (!pnIndex.empty())
+                        {
+                            index = index >= 1 && index <= pnIndex.size() ? pnIndex[index - 1] : 0;
+                        }
+                        index = index >= 1 ? index - 1 : UINT32_MAX;
                     }
 
+                    // the file already shares the points, keep them shared instead of emitting three vertices per triangle
+                    IfcGeometry geom;
+                    geom.AddIndexedFaces(points, indices, _creaseAngle);
+
                     // DumpIfcGeometry(geom, "test.obj");
 
                     _expressIDToGeometry[line.expressID] = geom;
@@ -625,13 +769,13 @@ namespace webifc::geometry
                     auto directrixRef = _loader.GetRefArgument();
                     bool closed = false;
 
-                    if (_loader.GetTokenType() == parsing::IfcTokenType::REAL)
+                    if (parsing::IsNumber(_loader.GetTokenType()))
                     {
                         _loader.StepBack();
                         startParam = _loader.GetDoubleArgument();
                     }
 
-                    if (_loader.GetTokenType() == parsing::IfcTokenType::REAL)
+                    if (parsing::IsNumber(_loader.GetTokenType()))
                     {
                         _loader.StepBack();
                         endParam = _loader.GetDoubleArgument();
@@ -641,7 +785,7 @@ namespace webifc::geometry
 
                     if (profileID)
                     {
-                        profile = _geometryLoader.GetProfile(profileID);
+                        profile = *_geometryLoader.GetProfile(profileID);
                     }
                     else
                     {
@@ -698,7 +842,7 @@ namespace webifc::geometry
                     double radius = _loader.GetDoubleArgument();
                     // double innerRadius = 0.0;
 
-                    if (_loader.GetTokenType() == parsing::IfcTokenType::REAL)
+                    if (parsing::IsNumber(_loader.GetTokenType()))
                     {
                         _errorHandler.ReportError(utility::LoaderErrorType::UNSUPPORTED_TYPE, "Inner radius of IFCSWEPTDISKSOLID currently not supported", line.expressID);
                         _loader.StepBack();
@@ -708,13 +852,13 @@ namespace webifc::geometry
                     // double startParam = 0;
                     // double endParam = 0;
 
-                    if (_loader.GetTokenType() == parsing::IfcTokenType::REAL)
+                    if (parsing::IsNumber(_loader.GetTokenType()))
                     {
                         _loader.StepBack();
                         _loader.GetDoubleArgument();
                     }
 
-                    if (_loader.GetTokenType() == parsing::IfcTokenType::REAL)
+                    if (parsing::IsNumber(_loader.GetTokenType()))
                     {
                         _loader.StepBack();
                         _loader.GetDoubleArgument();
@@ -723,7 +867,7 @@ namespace webifc::geometry
                     IfcCurve directrix = _geometryLoader.GetCurve(directrixRef,3);
 
                     IfcProfile profile;
-                    profile.curve = GetCircleCurve(radius, _circleSegments);
+                    profile.curve = GetCircleCurve(radius, _geometryLoader.GetCircleSegments(radius, 2 * CONST_PI));
 
                     IfcGeometry geom = Sweep(closed, profile, directrix);
 
@@ -743,15 +887,31 @@ namespace webifc::geometry
                     uint32_t axis1PlacementID = _loader.GetRefArgument();
                     double angle = _loader.GetDoubleArgument();
 
-                    IfcProfile profile = _geometryLoader.GetProfile(profileID);
+                    auto sharedProfile = _geometryLoader.GetProfile(profileID);
+                    const IfcProfile &profile = *sharedProfile;
                     glm::dmat4 placement = _geometryLoader.GetLocalPlacement(placementID);
                     glm::dvec3 axis;
 
                     bool closed = false;
 
-                    glm::dvec3 pos = _geometryLoader.GetAxis1Placement(axis1PlacementID)[0];
+                    auto axis1Placement = _geometryLoader.GetAxis1Placement(axis1PlacementID);
+                    glm::dvec3 pos = axis1Placement[0];
 
-                    IfcCurve directrix = BuildArc(pos, axis, angle,_circleSegments);
+                    // the profile point furthest from the axis sweeps the longest arc
+                    double radius = 0;
+                    glm::dvec3 axisDir = glm::normalize(axis1Placement[0]);
+                    auto addRadius = [&](const IfcCurve &curve)
+                    {
+                        for (auto &pt : curve.points)
+                        {
+                            glm::dvec3 d = pt - axis1Placement[1];
+                            radius = std::max(radius, glm::length(d - glm::dot(d, axisDir) * axisDir));
+                        }
+                    };
+                    addRadius(profile.curve);
+                    for (auto &child : profile.profiles) addRadius(child.curve);
+
+                    IfcCurve directrix = BuildArc(pos, axis, angle, _geometryLoader.GetCircleSegments(radius, angle));
 
                     IfcGeometry geom;
 
@@ -785,7 +945,8 @@ namespace webifc::geometry
                     uint32_t directionID = _loader.GetRefArgument();
                     double depth = _loader.GetDoubleArgument();
 
-                    IfcProfile profile = _geometryLoader.GetProfile(profileID);
+                    auto sharedProfile = _geometryLoader.GetProfile(profileID);
+                    const IfcProfile &profile = *sharedProfile;
                     if (!profile.isComposite)
                     {
                         if (profile.curve.points.empty())
@@ -1282,7 +1443,8 @@ namespace webifc::geometry
 
                 _loader.MoveToArgumentOffset(line, 0);
                 uint32_t profileID = _loader.GetRefArgument();
-                IfcProfile profile =  _geometryLoader.GetProfile(profileID);
+                auto sharedProfile = _geometryLoader.GetProfile(profileID);
+                const IfcProfile &profile = *sharedProfile;
 
                 _loader.MoveToArgumentOffset(line, 2);
                 uint32_t directionID = _loader.GetRefArgument();
@@ -1290,7 +1452,7 @@ namespace webifc::geometry
 
                 _loader.MoveToArgumentOffset(line, 3);
                 double length = 0;
-                if (_loader.GetTokenType() == parsing::IfcTokenType::REAL)
+                if (parsing::IsNumber(_loader.GetTokenType()))
                 {
                     _loader.StepBack();
                     length = _loader.GetDoubleArgument();
@@ -1324,8 +1486,12 @@ namespace webifc::geometry
     }
 
 
-    IfcFlatMesh IfcGeometryProcessor::GetFlatMesh(uint32_t expressID) 
+    // reverseMirrored false leaves the faces of mirrored placements as they are, so a geometry shared by several
+    // placements stays the same for all of them and the winding is left to the negative determinant of the transform
+    IfcFlatMesh IfcGeometryProcessor::GetFlatMesh(uint32_t expressID, bool reverseMirrored) 
     {
+        _elementBoolTime = 0;
+        IfcGeometry::degenerateInput = {};
         IfcFlatMesh flatMesh;
         flatMesh.expressID = expressID;
 
@@ -1333,12 +1499,23 @@ namespace webifc::geometry
 
         glm::dmat4 mat = glm::scale(glm::dvec3(_geometryLoader.GetLinearScalingFactor()));
 
-        AddComposedMeshToFlatMesh(flatMesh, composedMesh, _transformation * NormalizeIFC * mat);
+        AddComposedMeshToFlatMesh(flatMesh, composedMesh, _transformation * NormalizeIFC * mat, glm::dvec4(1, 1, 1, 1), false, reverseMirrored);
+
+        auto &degenerate = IfcGeometry::degenerateInput;
+        if (degenerate.nanPoints > 0 || degenerate.zeroAreaFaces > 0)
+        {
+            std::stringstream message;
+            message << "degenerate geometry: " << degenerate.nanPoints << " NaN points, " << degenerate.zeroAreaFaces << " zero area faces skipped";
+            _errorHandler.ReportError(utility::LoaderErrorType::DEGENERATE_GEOMETRY, message.str(), expressID, _loader.GetLine(_loader.ExpressIDToLineID(expressID)).ifcType);
+        }
+
+        // the element is complete, nothing built for it still uses the scratch of this thread
+        utility::ScratchArena::ForThisThread().Reset();
 
         return flatMesh;
     }
 
-    void IfcGeometryProcessor::AddComposedMeshToFlatMesh(IfcFlatMesh &flatMesh, const IfcComposedMesh &composedMesh, const glm::dmat4 &parentMatrix, const glm::dvec4 &color, bool hasColor)
+    void IfcGeometryProcessor::AddComposedMeshToFlatMesh(IfcFlatMesh &flatMesh, const IfcComposedMesh &composedMesh, const glm::dmat4 &parentMatrix, const glm::dvec4 &color, bool hasColor, bool reverseMirrored)
     {
         glm::dvec4 newParentColor = color;
         bool newHasColor = hasColor;
@@ -1380,7 +1557,7 @@ namespace webifc::geometry
             geometry.transformation = _coordinationMatrix * newMatrix * glm::translate(geom.min);
             geometry.SetFlatTransformation();
             geometry.geometryExpressID = composedMesh.expressID;
-            if(geometry.testReverse())
+            if(reverseMirrored && geometry.testReverse())
             {
                 geom.ReverseFaces();
             }
@@ -1390,7 +1567,7 @@ namespace webifc::geometry
 
         for (auto &c : composedMesh.children)
         {
-            AddComposedMeshToFlatMesh(flatMesh, c, newMatrix, newParentColor, newHasColor);
+            AddComposedMeshToFlatMesh(flatMesh, c, newMatrix, newParentColor, newHasColor, reverseMirrored);
         }
     }
 
@@ -1425,19 +1602,45 @@ namespace webifc::geometry
             }
         }
 
+        uint32_t firstPoints = 0;
+        uint32_t secondPoints = 0;
+        for (auto &geom : firstGeoms) firstPoints += geom.numPoints;
+        for (auto &geom : secondGeoms) secondPoints += geom.numPoints;
+        BoolTiming timing = { expressID, 0, firstPoints, secondPoints, false };
+
+        auto start = std::chrono::steady_clock::now();
+        auto elapsed = [&]() { return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count(); };
+
+        // broad phase, boxes are computed once per operand, subtracting can only shrink the first one
+        std::vector<std::pair<glm::dvec3, glm::dvec3>> secondBoxes(secondGeoms.size());
+        for (size_t i = 0; i < secondGeoms.size(); i++)
+        {
+            secondGeoms[i].GetCenterExtents(secondBoxes[i].first, secondBoxes[i].second);
+        }
+
+        // boxes grown by EPS_SMALL, touching boxes count as overlapping
+        auto overlaps = [](const glm::dvec3 &centerA, const glm::dvec3 &extentsA, const glm::dvec3 &centerB, const glm::dvec3 &extentsB)
+        {
+            glm::dvec3 distance = glm::abs(centerA - centerB);
+            glm::dvec3 reach = (extentsA + extentsB) / 2.0 + EPS_SMALL;
+            return distance.x <= reach.x && distance.y <= reach.y && distance.z <= reach.z;
+        };
+
         for (auto &firstGeom : firstGeoms)
         {
             IfcGeometry result = firstGeom;
-            for (auto &secondGeom : secondGeoms)
-            {
-                bool doit = true;
-                glm::dvec3 center;
-                glm::dvec3 extents;
-                result.GetCenterExtents(center, extents);
+            glm::dvec3 center;
+            glm::dvec3 extents;
+            result.GetCenterExtents(center, extents);
 
-                glm::dvec3 s_center;
-                glm::dvec3 s_extents;
-                secondGeom.GetCenterExtents(s_center, s_extents);
+            // the operands of this component, batched so that the boxes within a batch don't overlap,
+            // disjoint voids can't interact and one subtraction of the whole batch equals subtracting them one by one
+            std::vector<std::vector<size_t>> batches;
+            std::vector<uint32_t> batchPoints;
+
+            for (size_t i = 0; i < secondGeoms.size(); i++)
+            {
+                auto &secondGeom = secondGeoms[i];
 
                 if (secondGeom.numFaces == 0)
                 {
@@ -1445,9 +1648,64 @@ namespace webifc::geometry
 
                         // bail out because we will get strange meshes
                         // if this happens, probably there's an issue parsing the mesh that occurred earlier
-                    doit = false;
+                    continue;
+                }
+
+                // boxes that don't touch leave the first operand as it is, skip the conversion and the boolean
+                if (!overlaps(center, extents, secondBoxes[i].first, secondBoxes[i].second))
+                {
+                    continue;
+                }
+
+                if (_boolAbortThreshold > 0 && firstGeom.numPoints + secondGeom.numPoints > _boolAbortThreshold)
+                {
+                    // too complex, this operand is left out and the first one stays as it was
+                    std::stringstream message;
+                    message << "bool aborted, " << firstGeom.numPoints + secondGeom.numPoints << " points exceed the threshold of " << _boolAbortThreshold;
+                    _errorHandler.ReportError(utility::LoaderErrorType::BOOL_ERROR, message.str(), expressID);
+                    timing.aborted = true;
+                    continue;
+                }
+
+                size_t batch = batches.size();
+                if (_boolMergeOperands)
+                {
+                    for (batch = 0; batch < batches.size(); batch++)
+                    {
+                        // merged operands still have to stay under the threshold together
+                        if (_boolAbortThreshold > 0 && firstGeom.numPoints + batchPoints[batch] + secondGeom.numPoints > _boolAbortThreshold)
+                        {
+                            continue;
+                        }
+
+                        bool disjoint = true;
+                        for (auto other : batches[batch])
+                        {
+                            if (overlaps(secondBoxes[i].first, secondBoxes[i].second, secondBoxes[other].first, secondBoxes[other].second))
+                            {
+                                disjoint = false;
+                                break;
+                            }
+                        }
+
+                        if (disjoint)
+                        {
+                            break;
+                        }
+                    }
                 }
 
+                if (batch == batches.size())
+                {
+                    batches.emplace_back();
+                    batchPoints.push_back(0);
+                }
+                batches[batch].push_back(i);
+                batchPoints[batch] += secondGeom.numPoints;
+            }
+
+            for (auto &batch : batches)
+            {
                 if (result.numFaces == 0)
                 {
                     _errorHandler.ReportError(utility::LoaderErrorType::BOOL_ERROR, "bool aborted due to empty source or target");
@@ -1457,38 +1715,87 @@ namespace webifc::geometry
                     break;
                 }
 
-                if (doit)
+                if (_boolTimeBudget > 0 && _elementBoolTime + elapsed() > _boolTimeBudget)
                 {
-                   
-                    auto fb1 = GeomToFBGeom(result);
-                    auto fb2 = GeomToFBGeom(secondGeom);
+                    // over budget, the element keeps its unsubtracted geometry
+                    timing.milliseconds = elapsed();
+                    _elementBoolTime += timing.milliseconds;
+                    std::stringstream message;
+                    message << "bool aborted after " << timing.milliseconds << " ms, the element spent " << _elementBoolTime << " ms of a budget of " << _boolTimeBudget << " ms";
+                    _errorHandler.ReportError(utility::LoaderErrorType::BOOL_ERROR, message.str(), expressID);
+                    timing.aborted = true;
+                    AddBoolTimings({ timing });
+                    return flattenGeometry(firstGeoms);
+                }
 
-                    result = FBGeomToGeom(fuzzybools::Subtract(fb1, fb2));
+                // the disjoint operands of a batch form a single multi-body operand
+                fuzzybools::Geometry fb2;
+                for (auto i : batch)
+                {
+                    AddGeomToFBGeom(secondGeoms[i], fb2);
                 }
+
+                auto fb1 = GeomToFBGeom(result);
+                result = FBGeomToGeom(fuzzybools::Subtract(fb1, fb2));
             }
             results.push_back(result);
         }
 
+        timing.milliseconds = elapsed();
+        _elementBoolTime += timing.milliseconds;
+        AddBoolTimings({ timing });
+
         return flattenGeometry(results);
     }
 
-    std::vector<uint32_t> IfcGeometryProcessor::Read2DArrayOfThreeIndices()
+    // an unbounded half space is subtracted by cutting the first operand at its plane, instead of subtracting a large box,
+    // returns false if the operand is no IfcHalfSpaceSolid on a plane or the mesh can't be cut so the caller does the boolean
+    bool IfcGeometryProcessor::ClipByHalfSpace(const std::vector<IfcGeometry> &firstGroups, uint32_t halfSpaceID, const glm::dmat4 &normalizeMat, IfcGeometry &result)
     {
-        std::vector<uint32_t> result;
+        auto &line = _loader.GetLine(_loader.ExpressIDToLineID(halfSpaceID));
+        if (line.ifcType != schema::IFCHALFSPACESOLID)
+        {
+            return false;
+        }
 
-        _loader.GetTokenType();
+        _loader.MoveToArgumentOffset(line, 0);
+        uint32_t surfaceID = _loader.GetRefArgument();
+        std::string agreement = _loader.GetStringArgument();
 
-        // while we have point set begin
-        while (_loader.GetTokenType() == parsing::IfcTokenType::SET_BEGIN)
+        if (_loader.GetLine(_loader.ExpressIDToLineID(surfaceID)).ifcType != schema::IFCPLANE)
         {
-            result.push_back(static_cast<uint32_t>(_loader.GetDoubleArgument()));
-            result.push_back(static_cast<uint32_t>(_loader.GetDoubleArgument()));
-            result.push_back(static_cast<uint32_t>(_loader.GetDoubleArgument()));
+            return false;
+        }
 
-            // read point set end
-            _loader.GetTokenType();
+        // the material of the half space lies against the plane normal if the agreement flag is set
+        glm::dmat4 plane = normalizeMat * GetSurface(surfaceID).transformation;
+        glm::dvec3 planePos = plane[3];
+        glm::dvec3 planeNormal = plane[2];
+        if (agreement == "T")
+        {
+            planeNormal *= -1;
+        }
+
+        std::vector<IfcGeometry> results;
+        for (auto &geom : firstGroups)
+        {
+            IfcGeometry clipped;
+            if (!ClipByPlane(geom, planePos, planeNormal, clipped))
+            {
+                return false;
+            }
+            results.push_back(clipped);
         }
 
+        result = flattenGeometry(results);
+        return true;
+    }
+
+    std::vector<uint32_t> IfcGeometryProcessor::Read2DArrayOfThreeIndices(const parsing::IfcLine &line, uint32_t argumentIndex)
+    {
+        std::vector<uint32_t> result;
+        _loader.ReadNumberTuples<uint32_t>(line, argumentIndex, 3, result);
+
         return result;
     }
 
@@ -1510,7 +1817,7 @@ namespace webifc::geometry
             IfcGeometry geometry;
             for (auto &indexID : indexIDs)
             {
-                uint32_t index = static_cast<uint32_t>(_loader.GetDoubleArgument(indexID));
+                uint32_t index = static_cast<uint32_t>(_loader.GetIntArgument(indexID));
                 glm::dvec3 point = points[index - 1]; // indices are 1-based
 
                 // I am not proud of this
@@ -1536,7 +1843,7 @@ namespace webifc::geometry
                 while (_loader.GetTokenType() != parsing::IfcTokenType::SET_END)
                 {
                     _loader.StepBack();
-                    uint32_t index = static_cast<uint32_t>(_loader.GetDoubleArgument());
+                    uint32_t index = static_cast<uint32_t>(_loader.GetIntArgument());
 
                     glm::dvec3 point = points[index - 1]; // indices are still 1-based
 
@@ -1567,6 +1874,11 @@ namespace webifc::geometry
             _loader.MoveToArgumentOffset(line, 0);
             auto faces = _loader.GetSetArgument();
 
+            if (_brepThreads > 1 && _brepParallelFaces > 0 && faces.size() >= _brepParallelFaces)
+            {
+                return GetBrepInBatches(faces);
+            }
+
             IfcGeometry geometry;
             for (auto &faceToken : faces)
             {
@@ -1584,76 +1896,190 @@ namespace webifc::geometry
         return IfcGeometry();
     }
 
-    void IfcGeometryProcessor::AddFaceToGeometry(uint32_t expressID, IfcGeometry &geometry)
+    // faces are read a chunk at a time on this thread, the tape has a single cursor, and triangulated by _brepThreads threads in
+    // batches of consecutive faces, each into a geometry of its own that is appended in face order so the result is the serial one.
+    // the helper threads are started once per shell and wait for the next chunk in between
+    IfcGeometry IfcGeometryProcessor::GetBrepInBatches(const std::vector<uint32_t> &faceTokens)
     {
-        auto lineID = _loader.ExpressIDToLineID(expressID);
-        auto &line = _loader.GetLine(lineID);
-
-        switch (line.ifcType)
+        IfcGeometry geometry;
+        const size_t chunkSize = (size_t)_brepThreads * BREP_BATCH_FACES;
+        std::vector<BrepFace> chunk;
+        std::vector<IfcGeometry> batches;
+        std::vector<utility::LoaderErrorHandler> errorHandlers;
+        size_t count = 0;
+        size_t batchCount = 0;
+        std::atomic<size_t> nextBatch{0};
+        auto triangulateBatches = [&]()
         {
-        case schema::IFCFACE:
+            for (size_t batch = nextBatch++; batch < batchCount; batch = nextBatch++)
+            {
+                for (size_t i = batch * BREP_BATCH_FACES; i < std::min(count, (batch + 1) * BREP_BATCH_FACES); i++)
+                {
+                    TriangulateFace(chunk[i], batches[batch], errorHandlers[batch]);
+                }
+            }
+        };
+
+        std::mutex chunkMutex;
+        std::condition_variable chunkReady;
+        std::condition_variable chunkDone;
+        uint32_t generation = 0;
+        uint32_t busy = 0;
+        bool finished = false;
+        IfcGeometry::DegenerateInput helperDegenerateInput;
+        std::vector<std::thread> helpers;
+        for (uint32_t t = 1; t < _brepThreads; t++)
         {
-            _loader.MoveToArgumentOffset(line, 0);
-            auto bounds = _loader.GetSetArgument();
+            helpers.emplace_back([&]()
+            {
+                uint32_t seen = 0;
+                while (true)
+                {
+                    {
+                        std::unique_lock<std::mutex> lock(chunkMutex);
+                        chunkReady.wait(lock, [&]() { return finished || generation != seen; });
+                        if (finished) break;
+                        seen = generation;
+                    }
+                    triangulateBatches();
+                    // counted on this thread, handed to the calling one which reports them for the element
+                    auto degenerate = std::exchange(IfcGeometry::degenerateInput, {});
+                    std::lock_guard<std::mutex> lock(chunkMutex);
+                    helperDegenerateInput.nanPoints += degenerate.nanPoints;
+                    helperDegenerateInput.zeroAreaFaces += degenerate.zeroAreaFaces;
+                    if (--busy == 0) chunkDone.notify_one();
+                }
+                utility::ScratchArena::ForThisThread().Reset();
+            });
+        }
+
+        for (size_t first = 0; first < faceTokens.size(); first += chunkSize)
+        {
+            // the helpers are all waiting here, so the chunk can be refilled
+            count = std::min(chunkSize, faceTokens.size() - first);
+            chunk.clear();
+            chunk.resize(count);
+            for (size_t i = 0; i < count; i++)
+            {
+                ReadFace(_loader.GetRefArgument(faceTokens[first + i]), chunk[i]);
+            }
 
-            std::vector<IfcBound3D> bounds3D(bounds.size());
+            batchCount = (count + BREP_BATCH_FACES - 1) / BREP_BATCH_FACES;
+            batches.clear();
+            batches.resize(batchCount);
+            errorHandlers.clear();
+            errorHandlers.resize(batchCount);
+            {
+                std::lock_guard<std::mutex> lock(chunkMutex);
+                nextBatch = 0;
+                busy = helpers.size();
+                generation++;
+            }
+            chunkReady.notify_all();
 
-            for (size_t i = 0; i < bounds.size(); i++)
+            // this thread takes batches too, its scratch arena is only reset once the element is done
+            triangulateBatches();
             {
-                uint32_t boundID = _loader.GetRefArgument(bounds[i]);
-                bounds3D[i] = _geometryLoader.GetBound(boundID);
+                std::unique_lock<std::mutex> lock(chunkMutex);
+                chunkDone.wait(lock, [&]() { return busy == 0; });
+                IfcGeometry::degenerateInput.nanPoints += std::exchange(helperDegenerateInput.nanPoints, 0);
+                IfcGeometry::degenerateInput.zeroAreaFaces += std::exchange(helperDegenerateInput.zeroAreaFaces, 0);
             }
 
-            TriangulateBounds(geometry, bounds3D,_errorHandler);
-            break;
+            for (size_t batch = 0; batch < batchCount; batch++)
+            {
+                geometry.AddGeometry(std::move(batches[batch]));
+                _errorHandler.MergeErrors(errorHandlers[batch]);
+            }
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(chunkMutex);
+            finished = true;
+        }
+        chunkReady.notify_all();
+        for (auto &helper : helpers) helper.join();
+
+        return geometry;
+    }
+
+    void IfcGeometryProcessor::AddFaceToGeometry(uint32_t expressID, IfcGeometry &geometry)
+    {
+        BrepFace face;
+        if (ReadFace(expressID, face))
+        {
+            TriangulateFace(face, geometry, _errorHandler);
         }
+    }
+
+    bool IfcGeometryProcessor::ReadFace(uint32_t expressID, BrepFace &face)
+    {
+        auto lineID = _loader.ExpressIDToLineID(expressID);
+        auto &line = _loader.GetLine(lineID);
+
+        switch (line.ifcType)
+        {
+        case schema::IFCFACE:
         case schema::IFCADVANCEDFACE:
         {
             _loader.MoveToArgumentOffset(line, 0);
             auto bounds = _loader.GetSetArgument();
 
-            std::vector<IfcBound3D> bounds3D(bounds.size());
+            face.bounds.resize(bounds.size());
 
             for (size_t i = 0; i < bounds.size(); i++)
             {
                 uint32_t boundID = _loader.GetRefArgument(bounds[i]);
-                bounds3D[i] = _geometryLoader.GetBound(boundID);
+                face.bounds[i] = _geometryLoader.GetBound(boundID);
             }
 
-            _loader.MoveToArgumentOffset(line, 1);
-            auto surfRef = _loader.GetRefArgument();
-
-            auto surface = GetSurface(surfRef);
-
-            // TODO: place the face in the surface and tringulate
-
-            if (surface.BSplineSurface.Active)
+            if (line.ifcType == schema::IFCADVANCEDFACE)
             {
-                TriangulateBspline(geometry, bounds3D, surface);
-            }
-            else if (surface.CylinderSurface.Active)
-            {
-                TriangulateCylindricalSurface(geometry, bounds3D, surface);
-            }
-            else if (surface.RevolutionSurface.Active)
-            {
-                TriangulateRevolution(geometry, bounds3D, surface);
-            }
-            else if (surface.ExtrusionSurface.Active)
-            {
-                TriangulateExtrusion(geometry, bounds3D, surface);
-            }
-            else
-            {
-                TriangulateBounds(geometry, bounds3D,_errorHandler);
+                _loader.MoveToArgumentOffset(line, 1);
+                auto surfRef = _loader.GetRefArgument();
+
+                face.surface = GetSurface(surfRef);
+                face.hasSurface = true;
             }
-            break;
+            return true;
         }
         default:
             _errorHandler.ReportError(utility::LoaderErrorType::UNSUPPORTED_TYPE, "unexpected face type", line.expressID, line.ifcType);
-            break;
+            return false;
         }
     }
 
+    // touches neither the tape nor the processor, so faces can be triangulated on any thread
+    void IfcGeometryProcessor::TriangulateFace(BrepFace &face, IfcGeometry &geometry, utility::LoaderErrorHandler &errorHandler) const
+    {
+        if (!face.hasSurface)
+        {
+            TriangulateBounds(geometry, face.bounds, errorHandler);
+            return;
+        }
+
+        // TODO: place the face in the surface and tringulate
+
+        if (face.surface.BSplineSurface.Active)
+        {
+            TriangulateBspline(geometry, face.bounds, face.surface, _geometryLoader.GetCurveTessellation().maxDeviation);
+        }
+        else if (face.surface.CylinderSurface.Active)
+        {
+            TriangulateCylindricalSurface(geometry, face.bounds, face.surface);
+        }
+        else if (face.surface.RevolutionSurface.Active)
+        {
+            TriangulateRevolution(geometry, face.bounds, face.surface);
+        }
+        else if (face.surface.ExtrusionSurface.Active)
+        {
+            TriangulateExtrusion(geometry, face.bounds, face.surface);
+        }
+        else
+        {
+            TriangulateBounds(geometry, face.bounds, errorHandler);
+        }
+    }
 
 }
\ No newline at end of file
@@ -6,10 +6,13 @@
  
 #include <glm/glm.hpp>
 #include <string>
+#include <list>
+#include <unordered_map>
 #include "representation/geometry.h"
 #include "../parsing/IfcLoader.h"
 #include "../utility/LoaderError.h"
 #include "../schema/IfcSchemaManager.h"
+#include "../utility/LoaderSettings.h"
 #include "IfcGeometryLoader.h"
 
 namespace fuzzybools
@@ -20,24 +23,57 @@ namespace fuzzybools
 namespace webifc::geometry
 {
 
+  struct BoolTiming
+  {
+    uint32_t expressID;
+    double milliseconds;
+    uint32_t firstPoints;
+    uint32_t secondPoints;
+    bool aborted;
+  };
+
+  // a face of a shell as read from the tape, triangulated apart from reading so large shells can spread that over threads
+  struct BrepFace
+  {
+    std::vector<IfcBound3D> bounds;
+    // advanced faces only
+    bool hasSurface = false;
+    IfcSurface surface;
+  };
+
   // this class performs the processing of raw geometry data from the geometry loader to produce meshes
 
   class IfcGeometryProcessor 
   {
       public:
-        IfcGeometryProcessor(const webifc::parsing::IfcLoader &loader, webifc::utility::LoaderErrorHandler &errorHandler,const webifc::schema::IfcSchemaManager &schemaManager,uint16_t circleSegments,bool coordinateToOrigin);
+        // brepThreads is the number of threads large shells may be triangulated on, 1 keeps every shell on the calling thread
+        IfcGeometryProcessor(const webifc::parsing::IfcLoader &loader, webifc::utility::LoaderErrorHandler &errorHandler,const webifc::schema::IfcSchemaManager &schemaManager,const webifc::utility::LoaderSettings &settings, uint32_t brepThreads = 1);
         IfcGeometry &GetGeometry(uint32_t expressID);
-        IfcGeometryLoader GetLoader() const;
-        IfcFlatMesh GetFlatMesh(uint32_t expressID);
+        void SetGeometry(uint32_t expressID, IfcGeometry &&geometry);
+        const IfcGeometryLoader &GetLoader() const;
+        IfcFlatMesh GetFlatMesh(uint32_t expressID, bool reverseMirrored = true);
         IfcComposedMesh GetMesh(uint32_t expressID);
         void SetTransformation(const glm::dmat4 &val);
+        glm::dmat4 GetTransformation() const;
         glm::dmat4 GetCoordinationMatrix();
+        void SetCoordinationMatrix(const glm::dmat4 &val);
+        bool IsCoordinated() const;
+        const std::vector<BoolTiming> &GetSlowestBools() const;
+        void AddBoolTimings(const std::vector<BoolTiming> &timings);
+        std::vector<BoolTiming> TakeSlowestBools();
         void Clear();
+        void ClearCaches();
         
       private:
         void AddFaceToGeometry(uint32_t expressID, IfcGeometry &geometry);
+        bool ReadFace(uint32_t expressID, BrepFace &face);
+        void TriangulateFace(BrepFace &face, IfcGeometry &geometry, utility::LoaderErrorHandler &errorHandler) const;
         IfcGeometry GetBrep(uint32_t expressID);
+        IfcGeometry GetBrepInBatches(const std::vector<uint32_t> &faceTokens);
+        void CacheRepresentation(uint32_t expressID, const IfcComposedMesh &mesh);
+        bool RestoreRepresentation(uint32_t expressID, IfcComposedMesh &mesh);
         IfcGeometry BoolSubtract(const std::vector<IfcGeometry> &firstGroups, std::vector<IfcGeometry> &secondGroups, uint32_t expressID);
+        bool ClipByHalfSpace(const std::vector<IfcGeometry> &firstGroups, uint32_t halfSpaceID, const glm::dmat4 &normalizeMat, IfcGeometry &result);
         std::unordered_map<uint32_t, IfcGeometry> _expressIDToGeometry;
         std::unordered_map<uint32_t, IfcComposedMesh> _expressIDToMesh;
         IfcComposedMesh GetMeshByLine(uint32_t lineID);
@@ -49,13 +85,38 @@ namespace webifc::geometry
         const schema::IfcSchemaManager &_schemaManager;
         bool _isCoordinated = false;
         bool _coordinateToOrigin;
-        uint16_t _circleSegments;
         glm::dmat4 _coordinationMatrix = glm::dmat4(1.0);
-        void AddComposedMeshToFlatMesh(IfcFlatMesh &flatMesh, const IfcComposedMesh &composedMesh, const glm::dmat4 &parentMatrix = glm::dmat4(1), const glm::dvec4 &color = glm::dvec4(1, 1, 1, 1), bool hasColor = false);
-        std::vector<uint32_t> Read2DArrayOfThreeIndices();
+        // representation maps are shared by mapped items across elements, their meshes outlive Clear() in a LRU cache
+        struct CachedRepresentation
+        {
+            IfcComposedMesh mesh;
+            std::unordered_map<uint32_t, IfcGeometry> geometries;
+            size_t size;
+            std::list<uint32_t>::iterator lruPosition;
+        };
+        std::unordered_map<uint32_t, CachedRepresentation> _representationCache;
+        std::list<uint32_t> _representationLRU;
+        size_t _representationCacheSize = 0;
+        size_t _representationCacheLimit;
+        // booleans above this many points or past this many milliseconds per element are skipped, 0 disables either check
+        uint32_t _boolAbortThreshold;
+        uint32_t _boolTimeBudget;
+        double _elementBoolTime = 0;
+        // voids with disjoint boxes are subtracted together as one multi-body operand instead of one by one
+        bool _boolMergeOperands;
+        // radians between face normals up to which indexed tessellations share a vertex
+        double _creaseAngle;
+        // shells of at least this many faces are triangulated on _brepThreads threads, 0 keeps every shell on the calling thread
+        uint32_t _brepParallelFaces;
+        uint32_t _brepThreads;
+        static constexpr size_t BREP_BATCH_FACES = 1024;
+        std::vector<BoolTiming> _slowestBools;
+        void AddComposedMeshToFlatMesh(IfcFlatMesh &flatMesh, const IfcComposedMesh &composedMesh, const glm::dmat4 &parentMatrix = glm::dmat4(1), const glm::dvec4 &color = glm::dvec4(1, 1, 1, 1), bool hasColor = false, bool reverseMirrored = true);
+        std::vector<uint32_t> Read2DArrayOfThreeIndices(const parsing::IfcLine &line, uint32_t argumentIndex);
         void ReadIndexedPolygonalFace(uint32_t expressID, std::vector<IfcBound3D> &bounds, const std::vector<glm::dvec3> &points);
         fuzzybools::Geometry GeomToFBGeom(const IfcGeometry& geom);
         IfcGeometry FBGeomToGeom(const fuzzybools::Geometry& fbGeom);
+        void AddGeomToFBGeom(const IfcGeometry& geom, fuzzybools::Geometry& fbGeom);
 
   };
   
@@ -4,6 +4,8 @@
 
 #pragma once
 
+#include <algorithm>
+#include <cmath>
 #include "../representation/IfcCurve.h"
 
 namespace webifc::geometry {
@@ -14,6 +16,45 @@ namespace webifc::geometry {
 	}
 
 
+	// point count for an arc of the given radius and sweep, so that no chord strays further than the tolerance from it
+	// and no segment turns more than allowed, or the fixed circleSegments if the tessellation is not adaptive
+	inline uint16_t GetArcSegments(double radius, double sweepRad, uint16_t circleSegments, const CurveTessellation &tessellation)
+	{
+		radius = std::abs(radius);
+		double sweep = std::min<double>(std::abs(sweepRad), 2 * CONST_PI);
+		if (!tessellation.IsAdaptive() || !std::isfinite(radius) || !std::isfinite(sweep))
+		{
+			return circleSegments;
+		}
+
+		double segments = 1;
+		if (tessellation.maxAngle > 0)
+		{
+			segments = std::max(segments, std::ceil(sweep / tessellation.maxAngle));
+		}
+		// a chord over the angle a is radius * (1 - cos(a / 2)) away from the arc at its middle
+		if (tessellation.maxDeviation > 0 && radius > tessellation.maxDeviation)
+		{
+			segments = std::max(segments, std::ceil(sweep / (2 * std::acos(1 - tessellation.maxDeviation / radius))));
+		}
+		// both limits are for a full circle, an arc gets its share of them
+		double share = sweep / (2 * CONST_PI);
+		segments = std::min<double>(segments, std::max<double>(std::ceil(tessellation.maxSegments * share), 1));
+		segments = std::max<double>(segments, std::ceil(tessellation.minSegments * share));
+
+		return std::max<double>(segments, 1) + 1;
+	}
+
+	// radius and sweep of the arc from p1 through p2 to p3, the arc away from p2 spans twice the inscribed angle at p2
+	inline void GetArc3PtExtent(const glm::dvec2 &p1, const glm::dvec2 &p2, const glm::dvec2 &p3, double &radius, double &sweepRad)
+	{
+		glm::dvec2 a = p1 - p2;
+		glm::dvec2 b = p3 - p2;
+		double inscribed = std::acos(std::clamp(glm::dot(a, b) / (glm::length(a) * glm::length(b)), -1.0, 1.0));
+		radius = glm::length(p3 - p1) / (2 * std::sin(inscribed));
+		sweepRad = 2 * CONST_PI - 2 * inscribed;
+	}
+
 	inline IfcCurve BuildArc3Pt(const glm::dvec2 &p1, const glm::dvec2 &p2, const glm::dvec2 &p3,uint16_t circleSegments)
 	{
 		double f1 = (p1.x * p1.x - p2.x * p2.x + p1.y * p1.y - p2.y * p2.y);
@@ -65,7 +106,7 @@ namespace webifc::geometry {
 
 
 	
-	inline	glm::dvec3 InterpolateRationalBSplineCurveWithKnots(double t, int degree, std::vector<glm::dvec3> points, std::vector<double> knots, std::vector<double> weights)
+	inline	glm::dvec3 InterpolateRationalBSplineCurveWithKnots(double t, int degree, const std::vector<glm::dvec3> &points, const std::vector<double> &knots, const std::vector<double> &weights)
 	{
 		glm::dvec3 point;
 
@@ -128,7 +169,7 @@ namespace webifc::geometry {
 		return point;
 	}
 
-	inline	glm::dvec2 InterpolateRationalBSplineCurveWithKnots(double t, int degree, std::vector<glm::dvec2> points, std::vector<double> knots, std::vector<double> weights)
+	inline	glm::dvec2 InterpolateRationalBSplineCurveWithKnots(double t, int degree, const std::vector<glm::dvec2> &points, const std::vector<double> &knots, const std::vector<double> &weights)
 	{
 
 		glm::dvec2 point;
@@ -194,17 +235,75 @@ namespace webifc::geometry {
 
 
 
-	inline	std::vector<glm::dvec3> GetRationalBSplineCurveWithKnots(int degree, std::vector<glm::dvec3> points, std::vector<double> knots, std::vector<double> weights)
+	// adds the points strictly between t0 and t1, halving the span while its middle is off the chord by more than the
+	// tolerance or the two halves turn by more than the allowed angle
+	template <typename T, typename Evaluate>
+	inline void RefineCurveSpan(const Evaluate &evaluate, double t0, const T &p0, double t1, const T &p1, const CurveTessellation &tessellation, uint32_t depth, std::vector<T> &c)
+	{
+		if (depth == 0)
+		{
+			return;
+		}
+
+		double tm = (t0 + t1) / 2;
+		T pm = evaluate(tm);
+
+		T chord = p1 - p0;
+		double chordLength2 = glm::dot(chord, chord);
+		double along = chordLength2 > 0 ? std::clamp(glm::dot(pm - p0, chord) / chordLength2, 0.0, 1.0) : 0;
+		bool split = tessellation.maxDeviation > 0 && glm::length(pm - p0 - along * chord) > tessellation.maxDeviation;
+		if (!split && tessellation.maxAngle > 0)
+		{
+			T first = pm - p0;
+			T second = p1 - pm;
+			double lengths = glm::length(first) * glm::length(second);
+			split = lengths > 0 && std::acos(std::clamp(glm::dot(first, second) / lengths, -1.0, 1.0)) > tessellation.maxAngle;
+		}
+
+		if (split)
+		{
+			RefineCurveSpan(evaluate, t0, p0, tm, pm, tessellation, depth - 1, c);
+			c.push_back(pm);
+			RefineCurveSpan(evaluate, tm, pm, t1, p1, tessellation, depth - 1, c);
+		}
+	}
+
+	// samples the curve at twenty even steps of its parameter, refining each step when the tessellation is adaptive
+	template <typename T>
+	inline std::vector<T> SampleRationalBSplineCurve(int degree, const std::vector<T> &points, const std::vector<double> &knots, const std::vector<double> &weights, const CurveTessellation &tessellation)
 	{
+		constexpr uint32_t STEPS = 20;
+		auto evaluate = [&](double t) { return InterpolateRationalBSplineCurveWithKnots(t, degree, points, knots, weights); };
 
-		std::vector<glm::dvec3> c;
+		// every step may be halved until the whole curve reaches maxSegments
+		uint32_t depth = 0;
+		if (tessellation.IsAdaptive())
+		{
+			while ((STEPS << (depth + 1)) <= tessellation.maxSegments) depth++;
+		}
 
-		for (double i = 0; i < 1; i += 0.05)
+		std::vector<T> c;
+		double previous = 0;
+		for (double t = 0; t < 1; t += 1.0 / STEPS)
 		{
-			glm::dvec3 point = InterpolateRationalBSplineCurveWithKnots(i, degree, points, knots, weights);
+			T point = evaluate(t);
+			if (!c.empty())
+			{
+				T last = c.back();
+				RefineCurveSpan(evaluate, previous, last, t, point, tessellation, depth, c);
+			}
 			c.push_back(point);
+			previous = t;
 		}
 
+		return c;
+	}
+
+	inline	std::vector<glm::dvec3> GetRationalBSplineCurveWithKnots(int degree, const std::vector<glm::dvec3> &points, const std::vector<double> &knots, const std::vector<double> &weights, const CurveTessellation &tessellation = {})
+	{
+
+		std::vector<glm::dvec3> c = SampleRationalBSplineCurve(degree, points, knots, weights, tessellation);
+
 		// TODO: flip triangles?
 		/*
 				if (MatrixFlipsTriangles(placement))
@@ -216,15 +315,9 @@ namespace webifc::geometry {
 		return c;
 	}
 
-	inline	std::vector<glm::dvec2> GetRationalBSplineCurveWithKnots(int degree, std::vector<glm::dvec2> points, std::vector<double> knots, std::vector<double> weights)
+	inline	std::vector<glm::dvec2> GetRationalBSplineCurveWithKnots(int degree, const std::vector<glm::dvec2> &points, const std::vector<double> &knots, const std::vector<double> &weights, const CurveTessellation &tessellation = {})
 	{
-		std::vector<glm::dvec2> c;
-
-		for (double i = 0; i < 1; i += 0.05)
-		{
-			glm::dvec2 point = InterpolateRationalBSplineCurveWithKnots(i, degree, points, knots, weights);
-			c.push_back(point);
-		}
+		std::vector<glm::dvec2> c = SampleRationalBSplineCurve(degree, points, knots, weights, tessellation);
 		// TODO: flip triangles?
 		/*
 				if (MatrixFlipsTriangles(placement))
@@ -8,6 +8,7 @@
 #include "../representation/geometry.h"
 #include "../representation/IfcGeometry.h"
 #include "../../utility/LoaderError.h"
+#include "../../utility/ScratchArena.h"
 
 #include <mapbox/earcut.hpp>
 
@@ -216,6 +217,13 @@ namespace webifc::geometry {
 				dpts.erase(dpts.begin());
 			}
 
+			// two triangles of three points per segment and profile edge
+			if (!curves.empty() && curves[0].points.size() > 1)
+			{
+				uint32_t faces = 2 * (dpts.size() - 1) * (curves[0].points.size() - 1);
+				geom.Reserve(faces * 3, faces);
+			}
+
 			// connect the curves
 			for (size_t i = 1; i < dpts.size(); i++)
 			{
@@ -305,11 +313,93 @@ namespace webifc::geometry {
 			return false;
 		}
 
+		// triangles of a hole free loop, counter clockwise in 2d, without going through earcut: a quad is split along the diagonal
+		// through its reflex corner or else the shorter one, a strictly convex polygon becomes a fan, false leaves it to earcut
+		inline bool TriangulateConvexLoop(const utility::ScratchVector<std::array<double, 2>> &loop, std::vector<uint32_t> &indices)
+		{
+			// a closing point repeating the first one takes no part in the triangles
+			size_t count = loop.size();
+			if (count > 3 && loop[count - 1] == loop[0])
+			{
+				count--;
+			}
+			if (count < 4)
+			{
+				return false;
+			}
+
+			auto turn = [&](size_t i)
+			{
+				const auto &a = loop[(i + count - 1) % count];
+				const auto &b = loop[i];
+				const auto &c = loop[(i + 1) % count];
+				return (b[0] - a[0]) * (c[1] - b[1]) - (b[1] - a[1]) * (c[0] - b[0]);
+			};
+
+			if (count == 4)
+			{
+				uint32_t reflex = 0;
+				uint32_t reflexCount = 0;
+				for (uint32_t i = 0; i < 4; i++)
+				{
+					if (turn(i) <= 0)
+					{
+						reflex = i;
+						reflexCount++;
+					}
+				}
+
+				if (reflexCount == 0)
+				{
+					auto length2 = [&](size_t i, size_t j) { double dx = loop[j][0] - loop[i][0]; double dy = loop[j][1] - loop[i][1]; return dx * dx + dy * dy; };
+					reflex = length2(0, 2) <= length2(1, 3) ? 0 : 1;
+				}
+				else if (reflexCount > 1)
+				{
+					// degenerate or self intersecting
+					return false;
+				}
+
+				uint32_t a = reflex, b = (reflex + 1) % 4, c = (reflex + 2) % 4, d = (reflex + 3) % 4;
+				indices = {a, b, c, a, c, d};
+				return true;
+			}
+
+			// every corner turns left and the edges sweep round only once, more than two changes of direction along x would
+			// mean a star shaped loop winding round several times
+			uint32_t directionChanges = 0;
+			double previousDx = 0;
+			for (size_t i = 0; i <= count; i++)
+			{
+				if (i < count && turn(i) <= 0)
+				{
+					return false;
+				}
+				double dx = loop[(i + 1) % count][0] - loop[i % count][0];
+				if (dx != 0)
+				{
+					if (previousDx != 0 && (dx > 0) != (previousDx > 0)) directionChanges++;
+					previousDx = dx;
+				}
+			}
+			if (directionChanges > 2)
+			{
+				return false;
+			}
+
+			indices.reserve((count - 2) * 3);
+			for (uint32_t i = 1; i + 1 < count; i++)
+			{
+				indices.insert(indices.end(), {0, i, i + 1});
+			}
+			return true;
+		}
+
 		inline void TriangulateBounds(IfcGeometry &geometry, std::vector<IfcBound3D> &bounds,utility::LoaderErrorHandler &_errorHandler)
 		{
 			if (bounds.size() == 1 && bounds[0].curve.points.size() == 3)
 			{
-				auto c = bounds[0].curve;
+				const IfcCurve &c = bounds[0].curve;
 
 				// size_t offset = geometry.numPoints;
 
@@ -320,7 +410,8 @@ namespace webifc::geometry {
 				// bound greater than 4 vertices or with holes, triangulate
 				// TODO: modify to use glm::dvec2 with custom accessors
 				using Point = std::array<double, 2>;
-				std::vector<std::vector<Point>> polygon;
+				utility::ScratchVector<utility::ScratchVector<Point>> polygon;
+				polygon.reserve(bounds.size());
 
 				uint32_t offset = geometry.numPoints;
 
@@ -368,49 +459,53 @@ namespace webifc::geometry {
 				glm::dvec3 n = glm::normalize(glm::cross(v12, v13));
 				v12 = glm::cross(v13, n);
 
-				// check winding of outer bound
-				IfcCurve test;
-				for (size_t i = 0; i < bounds[0].curve.points.size(); i++)
+				// project the bounds onto the plane of the outer one to obtain 2d coords
+				auto project = [&](const IfcCurve &curve)
 				{
-					glm::dvec3 pt = bounds[0].curve.points[i];
-					glm::dvec3 pt2 = pt - v1;
-
-					glm::dvec2 proj(
-						glm::dot(pt2, v12),
-						glm::dot(pt2, v13));
+					utility::ScratchVector<Point> points;
+					points.reserve(curve.points.size());
+					for (auto &pt : curve.points)
+					{
+						glm::dvec3 pt2 = pt - v1;
+						points.push_back({glm::dot(pt2, v12), glm::dot(pt2, v13)});
+					}
+					return points;
+				};
 
-					test.Add(proj);
+				utility::ScratchVector<Point> outer = project(bounds[0].curve);
+				double area = 0;
+				for (size_t i = 0; i < outer.size(); i++)
+				{
+					const Point &a = outer[i];
+					const Point &b = outer[(i + 1) % outer.size()];
+					area += a[0] * b[1] - b[0] * a[1];
 				}
 
 				// if the outer bound is clockwise under the current projection (v12,v13,n), we invert the projection
-				if (!test.IsCCW())
+				if (area <= 0)
 				{
 					n *= -1;
 					std::swap(v12, v13);
+					for (auto &pt : outer) std::swap(pt[0], pt[1]);
 				}
 
+				// earcut makes n - 2 + 2 * holes triangles out of n shared points
+				uint32_t boundPoints = 0;
+				for (auto &bound : bounds) boundPoints += bound.curve.points.size();
+				geometry.Reserve(boundPoints, boundPoints + 2 * bounds.size());
+
 				for (auto &bound : bounds)
 				{
-					std::vector<Point> points;
-					for (size_t i = 0; i < bound.curve.points.size(); i++)
-					{
-						glm::dvec3 pt = bound.curve.points[i];
-						geometry.AddPoint(pt, n);
-
-						// project pt onto plane of curve to obtain 2d coords
-						glm::dvec3 pt2 = pt - v1;
-
-						glm::dvec2 proj(
-							glm::dot(pt2, v12),
-							glm::dot(pt2, v13));
-
-						points.push_back({proj.x, proj.y});
-					}
-
-					polygon.push_back(points);
+					for (auto &pt : bound.curve.points) geometry.AddPoint(pt, n);
 				}
 
-				std::vector<uint32_t> indices = mapbox::earcut<uint32_t>(polygon);
+				std::vector<uint32_t> indices;
+				if (bounds.size() > 1 || !TriangulateConvexLoop(outer, indices))
+				{
+					polygon.push_back(std::move(outer));
+					for (size_t i = 1; i < bounds.size(); i++) polygon.push_back(project(bounds[i].curve));
+					indices = mapbox::earcut<uint32_t>(polygon);
+				}
 
 				for (size_t i = 0; i < indices.size(); i += 3)
 				{
@@ -427,13 +522,18 @@ namespace webifc::geometry {
 		inline IfcGeometry Extrude(IfcProfile profile, glm::dvec3 dir, double distance,webifc::utility::LoaderErrorHandler _errorHandler, glm::dvec3 cuttingPlaneNormal = glm::dvec3(0), glm::dvec3 cuttingPlanePos = glm::dvec3(0))
 		{
 			IfcGeometry geom;
-			std::vector<bool> holesIndicesHash;
+			utility::ScratchVector<bool> holesIndicesHash;
+
+			// two caps sharing their points, then two triangles of three points per side edge
+			uint32_t profilePoints = profile.curve.points.size();
+			for (auto &hole : profile.holes) profilePoints += hole.points.size();
+			geom.Reserve(8 * profilePoints, 4 * profilePoints);
 
 			// build the caps
 			{
 				using Point = std::array<double, 2>;
 				int polygonCount = 1 + profile.holes.size(); // Main profile + holes
-				std::vector<std::vector<Point>> polygon(polygonCount);
+				utility::ScratchVector<utility::ScratchVector<Point>> polygon(polygonCount);
 
 				glm::dvec3 normal = dir;
 
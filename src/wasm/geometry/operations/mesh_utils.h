@@ -6,7 +6,9 @@
 
 #include <vector>
 #include <array>
+#include <algorithm>
 #include <unordered_map>
+#include <map>
 #include <optional>
 #include <tinynurbs/tinynurbs.h>
 #include "geometryutils.h"
@@ -567,8 +569,102 @@ namespace webifc::geometry
 	}
 
 
+	// surface points on a regular grid over the clamped knot domain, evaluated once per surface to seed inverse evaluations
+	struct BSplineSeedGrid
+	{
+		static constexpr uint32_t SIZE = 16;
+		double uMin, uMax, vMin, vMax;
+		std::vector<glm::dvec3> points;
+
+		BSplineSeedGrid(const tinynurbs::RationalSurface3d &srf)
+		{
+			uMin = srf.knots_u[srf.degree_u];
+			uMax = srf.knots_u[srf.knots_u.size() - srf.degree_u - 1];
+			vMin = srf.knots_v[srf.degree_v];
+			vMax = srf.knots_v[srf.knots_v.size() - srf.degree_v - 1];
+
+			points.reserve(SIZE * SIZE);
+			for (uint32_t i = 0; i < SIZE; i++)
+			{
+				for (uint32_t j = 0; j < SIZE; j++)
+				{
+					points.push_back(tinynurbs::surfacePoint(srf, U(i), V(j)));
+				}
+			}
+		}
+
+		double U(uint32_t i) const { return uMin + (uMax - uMin) * i / (SIZE - 1); }
+		double V(uint32_t j) const { return vMin + (vMax - vMin) * j / (SIZE - 1); }
+	};
+
+	// parameters of the surface point closest to pt, by Newton iterations on the squared distance from the nearest grid sample,
+	// returns false if they do not converge so the caller can fall back to a search
+	inline bool BSplineNewtonInverse(const glm::dvec3 &pt, const tinynurbs::RationalSurface3d &srf, const BSplineSeedGrid &grid, glm::dvec2 &uv)
+	{
+		constexpr uint32_t MAX_ITERATIONS = 20;
+		constexpr double EPS_COSINE = 1e-9;
+
+		size_t nearest = 0;
+		double nearestDistance = glm::distance(grid.points[0], pt);
+		for (size_t i = 1; i < grid.points.size(); i++)
+		{
+			double distance = glm::distance(grid.points[i], pt);
+			if (distance < nearestDistance)
+			{
+				nearest = i;
+				nearestDistance = distance;
+			}
+		}
+		double u = grid.U(nearest / BSplineSeedGrid::SIZE);
+		double v = grid.V(nearest % BSplineSeedGrid::SIZE);
+		double stepEps = EPS_COSINE * std::max(grid.uMax - grid.uMin, grid.vMax - grid.vMin);
+
+		for (uint32_t iteration = 0; iteration < MAX_ITERATIONS; iteration++)
+		{
+			auto ders = tinynurbs::surfaceDerivatives(srf, 2, u, v);
+			glm::dvec3 r = ders(0, 0) - pt;
+			glm::dvec3 su = ders(1, 0);
+			glm::dvec3 sv = ders(0, 1);
+			double distance = glm::length(r);
+
+			// on the surface, or r is perpendicular to it
+			if (distance < EPS_TINY || (std::abs(glm::dot(su, r)) <= EPS_COSINE * glm::length(su) * distance && std::abs(glm::dot(sv, r)) <= EPS_COSINE * glm::length(sv) * distance))
+			{
+				uv = glm::dvec2(u, v);
+				return true;
+			}
+
+			double fu = glm::dot(r, su);
+			double fv = glm::dot(r, sv);
+			double juu = glm::dot(su, su) + glm::dot(r, ders(2, 0));
+			double juv = glm::dot(su, sv) + glm::dot(r, ders(1, 1));
+			double jvv = glm::dot(sv, sv) + glm::dot(r, ders(0, 2));
+			double det = juu * jvv - juv * juv;
+			if (det <= 0)
+			{
+				return false;
+			}
+
+			double du = (juv * fv - jvv * fu) / det;
+			double dv = (juv * fu - juu * fv) / det;
+			double nu = std::clamp(u + du, grid.uMin, grid.uMax);
+			double nv = std::clamp(v + dv, grid.vMin, grid.vMax);
+
+			// stalled, usually against the boundary of the domain
+			if (std::abs(nu - u) + std::abs(nv - v) < stepEps)
+			{
+				uv = glm::dvec2(nu, nv);
+				return true;
+			}
+			u = nu;
+			v = nv;
+		}
+
+		return false;
+	}
+
 	// TODO: review and simplify
-	inline glm::dvec2 BSplineInverseEvaluation(glm::dvec3 pt, tinynurbs::RationalSurface3d srf)
+	inline glm::dvec2 BSplineInverseEvaluation(const glm::dvec3 &pt, const tinynurbs::RationalSurface3d &srf)
 	{
 		// Initial data
 
@@ -844,8 +940,13 @@ namespace webifc::geometry
 
 
 
+	// deviation of the triangles from the surface, relative to its size, when no maxDeviation is given
+	constexpr double BSPLINE_RELATIVE_DEVIATION = 1e-3;
+	constexpr uint32_t BSPLINE_MAX_REFINEMENTS = 5;
+	constexpr uint32_t BSPLINE_MAX_TRIANGLES = 1 << 16;
+
 		// TODO: review and simplify
-	inline void TriangulateBspline(IfcGeometry &geometry, std::vector<IfcBound3D> &bounds, IfcSurface &surface)
+	inline void TriangulateBspline(IfcGeometry &geometry, std::vector<IfcBound3D> &bounds, IfcSurface &surface, double maxDeviation = 0)
 	{
 			//			double limit = 1e-4;
 
@@ -910,77 +1011,433 @@ namespace webifc::geometry
 			using Point = std::array<double, 2>;
 			std::vector<std::vector<Point>> uvBoundaryValues;
 
+			BSplineSeedGrid grid(srf);
 			std::vector<Point> points;
 			for (size_t j = 0; j < bounds[0].curve.points.size(); j++)
 			{
 				glm::dvec3 pt = bounds[0].curve.points[j];
-				glm::dvec2 pInv = BSplineInverseEvaluation(pt, srf);
+				glm::dvec2 pInv;
+				if (!BSplineNewtonInverse(pt, srf, grid, pInv))
+				{
+					pInv = BSplineInverseEvaluation(pt, srf);
+				}
 				points.push_back({pInv.x, pInv.y});
 			}
 			uvBoundaryValues.push_back(points);
 
 				// Triangulate projected boundary
-				// Subdivide resulting triangles to increase definition
-				// r indicates the level of subdivision, currently 3 you can increase it to 5
 
 			std::vector<uint32_t> indices = mapbox::earcut<uint32_t>(uvBoundaryValues);
 
-			for (size_t r = 0; r < 3; r++)
+			utility::ScratchVector<glm::dvec2> uvs;
+			utility::ScratchVector<glm::dvec3> surfacePoints;
+			for (auto &uv : uvBoundaryValues[0])
 			{
-				std::vector<uint32_t> newIndices;
-				std::vector<Point> newUVPoints;
+				uvs.push_back(glm::dvec2(uv[0], uv[1]));
+				surfacePoints.push_back(tinynurbs::surfacePoint(srf, uv[0], uv[1]));
+			}
+
+			double tolerance = maxDeviation;
+			if (tolerance <= 0)
+			{
+				glm::dvec3 min = grid.points[0];
+				glm::dvec3 max = grid.points[0];
+				for (auto &pt : grid.points)
+				{
+					min = glm::min(min, pt);
+					max = glm::max(max, pt);
+				}
+				tolerance = BSPLINE_RELATIVE_DEVIATION * glm::distance(min, max);
+			}
+
+				// Subdivide where the surface bends away from the triangles, an edge is split when the surface at its middle
+				// or at the middle of one of its triangles is further than the tolerance from them, both triangles of an edge
+				// share the decision and its middle vertex so no cracks open
+
+			for (uint32_t level = 0; level < BSPLINE_MAX_REFINEMENTS && indices.size() / 3 < BSPLINE_MAX_TRIANGLES; level++)
+			{
+				std::unordered_map<uint64_t, uint32_t> middles;
+				bool refined = false;
+
+				auto edgeKey = [](uint32_t a, uint32_t b) { return (static_cast<uint64_t>(std::min(a, b)) << 32) | std::max(a, b); };
+				auto addMiddle = [&](uint32_t a, uint32_t b, const glm::dvec3 &pt)
+				{
+					uvs.push_back((uvs[a] + uvs[b]) / 2.0);
+					surfacePoints.push_back(pt);
+					middles[edgeKey(a, b)] = surfacePoints.size() - 1;
+					refined = true;
+				};
+				auto splitEdge = [&](uint32_t a, uint32_t b)
+				{
+					auto it = middles.find(edgeKey(a, b));
+					if (it == middles.end() || it->second == UINT32_MAX)
+					{
+						glm::dvec2 uv = (uvs[a] + uvs[b]) / 2.0;
+						addMiddle(a, b, tinynurbs::surfacePoint(srf, uv.x, uv.y));
+					}
+				};
+
+				for (size_t i = 0; i < indices.size(); i += 3)
+				{
+					uint32_t tri[3] = {indices[i + 0], indices[i + 1], indices[i + 2]};
+					for (uint32_t j = 0; j < 3; j++)
+					{
+						uint32_t a = tri[j];
+						uint32_t b = tri[(j + 1) % 3];
+						if (middles.count(edgeKey(a, b)) != 0)
+						{
+							continue;
+						}
+						glm::dvec2 uv = (uvs[a] + uvs[b]) / 2.0;
+						glm::dvec3 pt = tinynurbs::surfacePoint(srf, uv.x, uv.y);
+						if (glm::distance(pt, (surfacePoints[a] + surfacePoints[b]) / 2.0) > tolerance)
+						{
+							addMiddle(a, b, pt);
+						}
+						else
+						{
+							middles[edgeKey(a, b)] = UINT32_MAX;
+						}
+					}
+
+					glm::dvec2 uv = (uvs[tri[0]] + uvs[tri[1]] + uvs[tri[2]]) / 3.0;
+					glm::dvec3 pt = tinynurbs::surfacePoint(srf, uv.x, uv.y);
+					if (glm::distance(pt, (surfacePoints[tri[0]] + surfacePoints[tri[1]] + surfacePoints[tri[2]]) / 3.0) > tolerance)
+					{
+						for (uint32_t j = 0; j < 3; j++) splitEdge(tri[j], tri[(j + 1) % 3]);
+					}
+				}
+
+				if (!refined)
+				{
+					break;
+				}
 
+				std::vector<uint32_t> newIndices;
+				newIndices.reserve(indices.size() * 4);
 				for (size_t i = 0; i < indices.size(); i += 3)
 				{
-					Point p0 = uvBoundaryValues[0][indices[i + 0]];
-					Point p1 = uvBoundaryValues[0][indices[i + 1]];
-					Point p2 = uvBoundaryValues[0][indices[i + 2]];
+					uint32_t tri[3] = {indices[i + 0], indices[i + 1], indices[i + 2]};
+					uint32_t middle[3];
+					uint32_t splits = 0;
+					for (uint32_t j = 0; j < 3; j++)
+					{
+						middle[j] = middles[edgeKey(tri[j], tri[(j + 1) % 3])];
+						if (middle[j] != UINT32_MAX) splits++;
+					}
+
+					// rotate so the split edges come first, edge j runs from corner j to corner j + 1
+					uint32_t r = 0;
+					if (splits == 1)
+					{
+						while (middle[r] == UINT32_MAX) r++;
+					}
+					else if (splits == 2)
+					{
+						while (middle[(r + 2) % 3] != UINT32_MAX) r++;
+					}
+					uint32_t v0 = tri[r], v1 = tri[(r + 1) % 3], v2 = tri[(r + 2) % 3];
+					uint32_t m0 = middle[r], m1 = middle[(r + 1) % 3], m2 = middle[(r + 2) % 3];
+
+					auto add = [&](uint32_t a, uint32_t b, uint32_t c) { newIndices.insert(newIndices.end(), {a, b, c}); };
+					switch (splits)
+					{
+					case 0:
+						add(v0, v1, v2);
+						break;
+					case 1:
+						add(v0, m0, v2);
+						add(m0, v1, v2);
+						break;
+					case 2:
+						add(m0, v1, m1);
+						add(v0, m0, m1);
+						add(v0, m1, v2);
+						break;
+					default:
+						add(v0, m0, m2);
+						add(m0, v1, m1);
+						add(m0, m1, m2);
+						add(m2, m1, v2);
+						break;
+					}
+				}
+				indices = std::move(newIndices);
+			}
+
+				// every point of the parameter domain is evaluated once and shared by the triangles around it
+
+			utility::ScratchVector<glm::dvec3> normals(surfacePoints.size(), glm::dvec3(0));
+			utility::ScratchVector<uint32_t> faces;
+			for (size_t i = 0; i < indices.size(); i += 3)
+			{
+				glm::dvec3 n = glm::cross(surfacePoints[indices[i + 1]] - surfacePoints[indices[i]], surfacePoints[indices[i + 2]] - surfacePoints[indices[i]]);
+				if (glm::length(n) == 0)
+				{
+					continue;
+				}
+				for (uint32_t j = 0; j < 3; j++)
+				{
+					normals[indices[i + j]] += n;
+					faces.push_back(indices[i + j]);
+				}
+			}
+
+			uint32_t offset = geometry.numPoints;
+			geometry.Reserve(surfacePoints.size(), faces.size() / 3);
+			for (size_t i = 0; i < surfacePoints.size(); i++)
+			{
+				double length = glm::length(normals[i]);
+				geometry.AddPoint(surfacePoints[i], length > 0 ? normals[i] / length : glm::dvec3(0, 0, 1));
+			}
+			for (size_t i = 0; i < faces.size(); i += 3)
+			{
+				geometry.AddFace(offset + faces[i], offset + faces[i + 1], offset + faces[i + 2]);
+			}
+		}
+	}
+
+	// cuts a closed mesh by a plane, keeping the part behind it (dot(p - planePos, planeNormal) <= 0) and closing the cut with caps,
+	// returns false if the cut edges don't form closed loops, e.g. for open input, so the caller can fall back to a general boolean
+	inline bool ClipByPlane(const IfcGeometry &geom, const glm::dvec3 &planePos, const glm::dvec3 &planeNormal, IfcGeometry &result)
+	{
+		using Key = std::array<double, 3>;
+		using Point = std::array<double, 2>;
+
+		glm::dvec3 normal = glm::normalize(planeNormal);
+
+		auto distance = [&](const glm::dvec3 &pt)
+		{
+			double d = glm::dot(pt - planePos, normal);
+			return std::abs(d) < EPS_SMALL ? 0.0 : d;
+		};
+
+		auto key = [](const glm::dvec3 &pt) { return Key{pt.x, pt.y, pt.z}; };
+
+		// interpolate from the smaller end so both faces sharing an edge produce the exact same crossing point
+		auto crossing = [&](glm::dvec3 a, double da, glm::dvec3 b, double db)
+		{
+			if (key(b) < key(a))
+			{
+				std::swap(a, b);
+				std::swap(da, db);
+			}
+			return a + (b - a) * (da / (da - db));
+		};
+
+		// directed edges of the kept faces lying in the plane, an edge and its reverse cancel out
+		std::map<std::pair<Key, Key>, uint32_t> planeEdges;
+		auto addPlaneEdge = [&](const glm::dvec3 &a, const glm::dvec3 &b)
+		{
+			auto reverse = planeEdges.find({key(b), key(a)});
+			if (reverse != planeEdges.end())
+			{
+				if (--reverse->second == 0)
+				{
+					planeEdges.erase(reverse);
+				}
+			}
+			else
+			{
+				planeEdges[{key(a), key(b)}]++;
+			}
+		};
+
+		for (uint32_t i = 0; i < geom.numFaces; i++)
+		{
+			Face f = geom.GetFace(i);
+			glm::dvec3 pts[3] = {geom.GetPoint(f.i0), geom.GetPoint(f.i1), geom.GetPoint(f.i2)};
+			double d[3] = {distance(pts[0]), distance(pts[1]), distance(pts[2])};
+
+			if (d[0] == 0 && d[1] == 0 && d[2] == 0)
+			{
+				// a face in the plane bounds the kept part only if it faces the cut away side
+				if (glm::dot(glm::cross(pts[1] - pts[0], pts[2] - pts[0]), normal) > 0)
+				{
+					result.AddFace(pts[0], pts[1], pts[2]);
+					addPlaneEdge(pts[0], pts[1]);
+					addPlaneEdge(pts[1], pts[2]);
+					addPlaneEdge(pts[2], pts[0]);
+				}
+				continue;
+			}
+
+			if (d[0] >= 0 && d[1] >= 0 && d[2] >= 0)
+			{
+				continue;
+			}
+
+			// clip the triangle, the kept part is convex with at most four corners
+			glm::dvec3 polygon[4];
+			bool onPlane[4];
+			size_t corners = 0;
+			for (int j = 0; j < 3; j++)
+			{
+				int k = (j + 1) % 3;
+				if (d[j] <= 0)
+				{
+					polygon[corners] = pts[j];
+					onPlane[corners++] = d[j] == 0;
+				}
+				if ((d[j] < 0 && d[k] > 0) || (d[j] > 0 && d[k] < 0))
+				{
+					polygon[corners] = crossing(pts[j], d[j], pts[k], d[k]);
+					onPlane[corners++] = true;
+				}
+			}
+
+			for (size_t j = 1; j + 1 < corners; j++)
+			{
+				result.AddFace(polygon[0], polygon[j], polygon[j + 1]);
+			}
+
+			for (size_t j = 0; j < corners; j++)
+			{
+				size_t k = (j + 1) % corners;
+				if (onPlane[j] && onPlane[k])
+				{
+					addPlaneEdge(polygon[j], polygon[k]);
+				}
+			}
+		}
 
-					newUVPoints.push_back(p0);
-					newUVPoints.push_back(p1);
-					newUVPoints.push_back(p2);
+		if (planeEdges.empty())
+		{
+			return true;
+		}
 
-					Point p3 = {(p0[0] + p1[0]) / 2, (p0[1] + p1[1]) / 2};
-					Point p4 = {(p0[0] + p2[0]) / 2, (p0[1] + p2[1]) / 2};
-					Point p5 = {(p1[0] + p2[0]) / 2, (p1[1] + p2[1]) / 2};
+		// the cap runs against the open edges of the kept part
+		std::map<Key, std::vector<Key>> capEdges;
+		for (auto &[edge, count] : planeEdges)
+		{
+			for (uint32_t i = 0; i < count; i++)
+			{
+				capEdges[edge.second].push_back(edge.first);
+			}
+		}
 
-					newUVPoints.push_back(p3);
-					newUVPoints.push_back(p4);
-					newUVPoints.push_back(p5);
+		glm::dvec3 u = std::abs(normal.x) < 0.9 ? glm::dvec3(1, 0, 0) : glm::dvec3(0, 1, 0);
+		u = glm::normalize(glm::cross(normal, u));
+		glm::dvec3 v = glm::cross(normal, u);
+		auto project = [&](const Key &pt)
+		{
+			glm::dvec3 rel = glm::dvec3(pt[0], pt[1], pt[2]) - planePos;
+			return Point{glm::dot(rel, u), glm::dot(rel, v)};
+		};
 
-					int offset = newUVPoints.size() - 6;
+		std::vector<std::vector<Key>> loops;
+		while (!capEdges.empty())
+		{
+			Key start = capEdges.begin()->first;
+			std::vector<Key> loop;
+			Key current = start;
+			do
+			{
+				auto it = capEdges.find(current);
+				if (it == capEdges.end())
+				{
+					return false;
+				}
+				loop.push_back(current);
+				current = it->second.back();
+				it->second.pop_back();
+				if (it->second.empty())
+				{
+					capEdges.erase(it);
+				}
+			} while (current != start);
+			loops.push_back(loop);
+		}
 
-					newIndices.push_back(offset + 0);
-					newIndices.push_back(offset + 3);
-					newIndices.push_back(offset + 4);
+		// seen from the cut away side outer loops run counter clockwise and holes clockwise
+		std::vector<std::vector<Point>> loops2D;
+		std::vector<double> areas;
+		for (auto &loop : loops)
+		{
+			std::vector<Point> loop2D;
+			double area = 0;
+			for (size_t i = 0; i < loop.size(); i++)
+			{
+				loop2D.push_back(project(loop[i]));
+			}
+			for (size_t i = 0; i < loop2D.size(); i++)
+			{
+				auto &a = loop2D[i];
+				auto &b = loop2D[(i + 1) % loop2D.size()];
+				area += a[0] * b[1] - b[0] * a[1];
+			}
+			loops2D.push_back(loop2D);
+			areas.push_back(area / 2);
+		}
 
-					newIndices.push_back(offset + 3);
-					newIndices.push_back(offset + 5);
-					newIndices.push_back(offset + 4);
+		auto inside = [](const std::vector<Point> &loop, const Point &pt)
+		{
+			bool in = false;
+			for (size_t i = 0, j = loop.size() - 1; i < loop.size(); j = i++)
+			{
+				if ((loop[i][1] > pt[1]) != (loop[j][1] > pt[1]) &&
+					pt[0] < (loop[j][0] - loop[i][0]) * (pt[1] - loop[i][1]) / (loop[j][1] - loop[i][1]) + loop[i][0])
+				{
+					in = !in;
+				}
+			}
+			return in;
+		};
 
-					newIndices.push_back(offset + 3);
-					newIndices.push_back(offset + 1);
-					newIndices.push_back(offset + 5);
+		std::vector<std::vector<size_t>> holes(loops.size());
+		for (size_t i = 0; i < loops.size(); i++)
+		{
+			if (areas[i] >= 0)
+			{
+				continue;
+			}
 
-					newIndices.push_back(offset + 4);
-					newIndices.push_back(offset + 5);
-					newIndices.push_back(offset + 2);
+			// a hole belongs to the smallest outer loop around it
+			size_t outer = loops.size();
+			for (size_t j = 0; j < loops.size(); j++)
+			{
+				if (areas[j] > 0 && inside(loops2D[j], loops2D[i][0]) && (outer == loops.size() || areas[j] < areas[outer]))
+				{
+					outer = j;
 				}
+			}
+			if (outer == loops.size())
+			{
+				return false;
+			}
+			holes[outer].push_back(i);
+		}
 
-				uvBoundaryValues[0] = newUVPoints;
-				indices = newIndices;
+		for (size_t i = 0; i < loops.size(); i++)
+		{
+			if (areas[i] <= 0)
+			{
+				continue;
 			}
 
-			for (size_t i = 0; i < indices.size(); i += 3)
+			std::vector<std::vector<Point>> polygon = {loops2D[i]};
+			std::vector<Key> points = loops[i];
+			for (auto hole : holes[i])
 			{
-				Point p0 = uvBoundaryValues[0][indices[i + 0]];
-				Point p1 = uvBoundaryValues[0][indices[i + 1]];
-				Point p2 = uvBoundaryValues[0][indices[i + 2]];
-				glm::dvec3 pt00 = tinynurbs::surfacePoint(srf, p0[0], p0[1]);
-				glm::dvec3 pt01 = tinynurbs::surfacePoint(srf, p1[0], p1[1]);
-				glm::dvec3 pt10 = tinynurbs::surfacePoint(srf, p2[0], p2[1]);
-				geometry.AddFace(pt00, pt01, pt10);
+				polygon.push_back(loops2D[hole]);
+				points.insert(points.end(), loops[hole].begin(), loops[hole].end());
+			}
+
+			std::vector<uint32_t> indices = mapbox::earcut<uint32_t>(polygon);
+			for (size_t j = 0; j + 2 < indices.size(); j += 3)
+			{
+				glm::dvec3 a(points[indices[j]][0], points[indices[j]][1], points[indices[j]][2]);
+				glm::dvec3 b(points[indices[j + 1]][0], points[indices[j + 1]][1], points[indices[j + 1]][2]);
+				glm::dvec3 c(points[indices[j + 2]][0], points[indices[j + 2]][1], points[indices[j + 2]][2]);
+
+				if (glm::dot(glm::cross(b - a, c - a), normal) < 0)
+				{
+					std::swap(b, c);
+				}
+				result.AddFace(a, b, c);
 			}
 		}
+
+		return true;
 	}
 }
\ No newline at end of file
@@ -26,4 +26,16 @@ namespace webifc::geometry {
 			static constexpr double EPS_TINY = 1e-9;
 	};
 
+	// how finely circles, arcs, ellipses and B-spline curves are sampled, with neither a deviation nor an angle set every
+	// circle gets the fixed segment count whatever its size
+	struct CurveTessellation
+	{
+		double maxDeviation = 0; // largest distance between a chord and the curve, in metres until the geometry loader scales it to file units
+		double maxAngle = 0; // degrees a single segment may turn, radians once in the geometry loader
+		uint16_t minSegments = 4; // segments of a full circle, arcs get their share
+		uint16_t maxSegments = 256;
+
+		bool IsAdaptive() const { return maxDeviation > 0 || maxAngle > 0; }
+	};
+
 }
\ No newline at end of file
@@ -4,7 +4,10 @@
 
 // Implementation for IfcGeometry
 
+#include <cmath>
+#include <cstring>
 #include "IfcGeometry.h"
+#include "../../utility/ScratchArena.h"
 
 namespace webifc::geometry {
 
@@ -31,10 +34,27 @@ namespace webifc::geometry {
 		components.push_back(g);
 	}
 
-	void IfcGeometry::AddPoint(glm::dvec4 &pt, glm::dvec3 &n)
+	thread_local IfcGeometry::DegenerateInput IfcGeometry::degenerateInput;
+
+	// makes room for this many more points and faces, growing at least geometrically so repeated hints stay amortized
+	void IfcGeometry::Reserve(uint32_t points, uint32_t faces)
+	{
+		size_t vertexSize = vertexData.size() + (size_t)points * VERTEX_FORMAT_SIZE_FLOATS;
+		if (vertexSize > vertexData.capacity())
+		{
+			vertexData.reserve(std::max(vertexSize, vertexData.capacity() * 2));
+		}
+
+		size_t indexSize = indexData.size() + (size_t)faces * 3;
+		if (indexSize > indexData.capacity())
+		{
+			indexData.reserve(std::max(indexSize, indexData.capacity() * 2));
+		}
+	}
+
+	void IfcGeometry::AddPoint(const glm::dvec4 &pt, const glm::dvec3 &n)
 	{
-		glm::dvec3 p = pt;
-		AddPoint(p, n);
+		AddPoint(glm::dvec3(pt), n);
 	}
 
 	// just follow the ifc spec, damn
@@ -57,27 +77,18 @@ namespace webifc::geometry {
 		return true;
 	}
 
-	void IfcGeometry::AddPoint(glm::dvec3 &pt, glm::dvec3 &n)
+	void IfcGeometry::AddPoint(const glm::dvec3 &pt, const glm::dvec3 &n)
 	{
-		auto const source = std::vector<double>{pt.x, pt.y, pt.z, n.x, n.y, n.z};
-		vertexData.insert(vertexData.end(), source.begin(), source.end());
-		
+		vertexData.insert(vertexData.end(), {pt.x, pt.y, pt.z, n.x, n.y, n.z});
 
 		min = glm::min(min, pt);
 		max = glm::max(max, pt);
 
-
-		if (std::isnan(pt.x) || std::isnan(pt.y) || std::isnan(pt.z))
+		if (std::isnan(pt.x) || std::isnan(pt.y) || std::isnan(pt.z) || std::isnan(n.x) || std::isnan(n.y) || std::isnan(n.z))
 		{
-			printf("NaN in geom!\n");
+			degenerateInput.nanPoints++;
 		}
 
-		if (std::isnan(n.x) || std::isnan(n.y) || std::isnan(n.z))
-		{
-			printf("NaN in geom!\n");
-		}
-
-
 		numPoints += 1;
 	}
 
@@ -87,7 +98,7 @@ namespace webifc::geometry {
 		if (!computeSafeNormal(a, b, c, normal))
 		{
 			// bail out, zero area triangle
-			printf("zero tri\n");
+			degenerateInput.zeroAreaFaces++;
 			return;
 		}
 
@@ -100,12 +111,113 @@ namespace webifc::geometry {
 
 	void IfcGeometry::AddFace(uint32_t a, uint32_t b, uint32_t c)
 	{
-		auto const source = std::vector<uint32_t>{a, b, c};
-		indexData.insert(indexData.end(), source.begin(), source.end());
+		indexData.insert(indexData.end(), {a, b, c});
 
 		numFaces++;
 	}
 
+	// adds triangles indexing into a shared point list, faces around a point share one vertex as long as their normals
+	// are within creaseAngle (radians) of the first face of the group, the vertex normal is the area weighted average
+	void IfcGeometry::AddIndexedFaces(const std::vector<glm::dvec3> &points, const std::vector<uint32_t> &indices, double creaseAngle)
+	{
+		size_t faceCount = indices.size() / 3;
+		utility::ScratchVector<glm::dvec3> faceNormals(faceCount);
+		utility::ScratchVector<bool> valid(faceCount, false);
+		utility::ScratchVector<uint32_t> incidentCount(points.size() + 1, 0);
+
+		for (size_t f = 0; f < faceCount; f++)
+		{
+			uint32_t i0 = indices[f * 3 + 0];
+			uint32_t i1 = indices[f * 3 + 1];
+			uint32_t i2 = indices[f * 3 + 2];
+			if (i0 >= points.size() || i1 >= points.size() || i2 >= points.size() || i0 == i1 || i1 == i2 || i0 == i2)
+			{
+				continue;
+			}
+
+			// unnormalized, its length weights the vertex normals by area
+			faceNormals[f] = glm::cross(points[i1] - points[i0], points[i2] - points[i0]);
+			if (glm::length(faceNormals[f]) == 0)
+			{
+				// zero area triangle
+				continue;
+			}
+
+			valid[f] = true;
+			for (size_t j = 0; j < 3; j++) incidentCount[indices[f * 3 + j] + 1]++;
+		}
+
+		// faces around each point
+		for (size_t i = 0; i < points.size(); i++) incidentCount[i + 1] += incidentCount[i];
+		utility::ScratchVector<uint32_t> incidentFaces(incidentCount.back());
+		utility::ScratchVector<uint32_t> fill(incidentCount.begin(), incidentCount.end() - 1);
+		for (size_t f = 0; f < faceCount; f++)
+		{
+			if (!valid[f]) continue;
+			for (size_t j = 0; j < 3; j++) incidentFaces[fill[indices[f * 3 + j]]++] = f;
+		}
+
+		double creaseCos = std::cos(creaseAngle);
+		utility::ScratchVector<uint32_t> cornerVertices(faceCount * 3);
+		struct Group
+		{
+			glm::dvec3 seed;
+			glm::dvec3 normal;
+		};
+		utility::ScratchVector<Group> groups;
+		utility::ScratchVector<uint32_t> faceGroups;
+
+		for (size_t i = 0; i < points.size(); i++)
+		{
+			groups.clear();
+			faceGroups.clear();
+
+			for (uint32_t k = incidentCount[i]; k < incidentCount[i + 1]; k++)
+			{
+				glm::dvec3 n = faceNormals[incidentFaces[k]];
+				glm::dvec3 unit = glm::normalize(n);
+
+				size_t g = 0;
+				for (; g < groups.size(); g++)
+				{
+					if (glm::dot(groups[g].seed, unit) >= creaseCos) break;
+				}
+				if (g == groups.size())
+				{
+					groups.push_back({unit, glm::dvec3(0)});
+				}
+				groups[g].normal += n;
+				faceGroups.push_back(g);
+			}
+
+			uint32_t first = numPoints;
+			for (auto &group : groups)
+			{
+				glm::dvec3 pt = points[i];
+				// opposite faces in one group cancel out, keep the first one's normal then
+				glm::dvec3 n = glm::length(group.normal) > 0 ? glm::normalize(group.normal) : group.seed;
+				AddPoint(pt, n);
+			}
+
+			for (uint32_t k = incidentCount[i]; k < incidentCount[i + 1]; k++)
+			{
+				uint32_t f = incidentFaces[k];
+				for (size_t j = 0; j < 3; j++)
+				{
+					if (indices[f * 3 + j] == i) cornerVertices[f * 3 + j] = first + faceGroups[k - incidentCount[i]];
+				}
+			}
+		}
+
+		for (size_t f = 0; f < faceCount; f++)
+		{
+			if (valid[f])
+			{
+				AddFace(cornerVertices[f * 3 + 0], cornerVertices[f * 3 + 1], cornerVertices[f * 3 + 2]);
+			}
+		}
+	}
+
 	void IfcGeometry::ReverseFace(uint32_t index)
 	{
 			Face f = GetFace(index);
@@ -195,23 +307,62 @@ namespace webifc::geometry {
 
 	uint32_t IfcGeometry::GetVertexData()
 	{
-		// unfortunately webgl can't do doubles
-		if (fvertexData.size() != vertexData.size())
+		// unfortunately webgl can't do doubles, rebuilt while the doubles are around and the buffer is stale
+		bool upToDate = fvertexData.size() == numPoints * VertexFormatWords(vertexFormat) && builtVertexFormat == vertexFormat;
+		if (!upToDate && vertexData.size() == numPoints * VERTEX_FORMAT_SIZE_FLOATS)
 		{
-			fvertexData.resize(vertexData.size());
-			for (size_t i = 0; i < vertexData.size(); i += 6)
-			{
-				fvertexData[i + 0] = vertexData[i + 0];
-				fvertexData[i + 1] = vertexData[i + 1];
-				fvertexData[i + 2] = vertexData[i + 2];
+			fvertexData.resize(numPoints * VertexFormatWords(vertexFormat));
+			builtVertexFormat = vertexFormat;
 
-				fvertexData[i + 3] = vertexData[i + 3];
-				fvertexData[i + 4] = vertexData[i + 4];
-				fvertexData[i + 5] = vertexData[i + 5];
+			if (vertexFormat == VERTEX_FLOAT)
+			{
+				for (size_t i = 0; i < vertexData.size(); i++)
+				{
+					fvertexData[i] = vertexData[i];
+				}
+			}
+			else
+			{
+				// the packed layouts are written byte wise into the float words
+				glm::dvec3 extent = max - min;
+				glm::dvec3 offset = normalized ? glm::dvec3(0) : min;
+				uint8_t *out = reinterpret_cast<uint8_t *>(fvertexData.data());
+
+				for (size_t i = 0; i < numPoints; i++)
+				{
+					const double *v = &vertexData[i * VERTEX_FORMAT_SIZE_FLOATS];
+
+					if (vertexFormat == VERTEX_FLOAT_OCT)
+					{
+						float position[3] = {(float)v[0], (float)v[1], (float)v[2]};
+						memcpy(out, position, sizeof(position));
+						out += sizeof(position);
+					}
+					else
+					{
+						uint16_t position[4] = {0, 0, 0, 0};
+						for (int j = 0; j < 3; j++)
+						{
+							double t = extent[j] > 0 ? (v[j] - offset[j]) / extent[j] : 0;
+							position[j] = (uint16_t)std::lround(std::clamp(t, 0.0, 1.0) * 65535);
+						}
+						memcpy(out, position, sizeof(position));
+						out += sizeof(position);
+					}
+
+					// octahedral encoding, the lower hemisphere folds over the diagonals
+					glm::dvec3 n(v[3], v[4], v[5]);
+					n /= std::abs(n.x) + std::abs(n.y) + std::abs(n.z);
+					glm::dvec2 oct(n.x, n.y);
+					if (n.z < 0)
+					{
+						oct = glm::dvec2((1 - std::abs(n.y)) * (n.x >= 0 ? 1 : -1), (1 - std::abs(n.x)) * (n.y >= 0 ? 1 : -1));
+					}
+					int16_t normal[2] = {(int16_t)std::lround(std::clamp(oct.x, -1.0, 1.0) * 32767), (int16_t)std::lround(std::clamp(oct.y, -1.0, 1.0) * 32767)};
+					memcpy(out, normal, sizeof(normal));
+					out += sizeof(normal);
+				}
 			}
-
-			// cleanup
-			// vertexData = {};
 		}
 
 		if (fvertexData.empty())
@@ -222,6 +373,25 @@ namespace webifc::geometry {
 		return (uint32_t)(size_t)&fvertexData[0];
 	}
 
+	// maps the unorm16 positions of VERTEX_QUANTIZED_OCT back to the geometry's coordinates, column major like flat transformations
+	std::array<double, 16> IfcGeometry::GetDequantizationMatrix() const
+	{
+		glm::dvec3 scale = numPoints > 0 ? (max - min) / 65535.0 : glm::dvec3(0);
+		glm::dvec3 offset = normalized || numPoints == 0 ? glm::dvec3(0) : min;
+
+		return {
+			scale.x, 0, 0, 0,
+			0, scale.y, 0, 0,
+			0, 0, scale.z, 0,
+			offset.x, offset.y, offset.z, 1};
+	}
+
+	// frees the doubles once the output buffer is built, the geometry can't be processed or rebuilt in another format after this
+	void IfcGeometry::ReleaseDoubleVertexData()
+	{
+		std::vector<double>().swap(vertexData);
+	}
+
 	void IfcGeometry::AddGeometry(IfcGeometry geom)
 	{
 		uint32_t maxIndex = numPoints;
@@ -253,4 +423,42 @@ namespace webifc::geometry {
 		return (uint32_t)indexData.size();
 	}
 
+	// FNV-1a over the faces and the vertices snapped to a grid of the given size, call on normalized geometry
+	// so that identical shapes at different positions hash the same, normals are snapped to a fixed 1e-4 grid
+	uint64_t IfcGeometry::GetContentHash(double tolerance) const
+	{
+		uint64_t hash = 14695981039346656037ULL;
+		auto combine = [&hash](int64_t value)
+		{
+			for (int i = 0; i < 8; i++)
+			{
+				hash ^= (value >> (i * 8)) & 0xFF;
+				hash *= 1099511628211ULL;
+			}
+		};
+
+		combine(numPoints);
+		combine(numFaces);
+		for (size_t i = 0; i < vertexData.size(); i += 6)
+		{
+			for (size_t j = 0; j < 3; j++) combine(std::llround(vertexData[i + j] / tolerance));
+			for (size_t j = 3; j < 6; j++) combine(std::llround(vertexData[i + j] * 1e4));
+		}
+		for (auto index : indexData) combine(index);
+
+		return hash;
+	}
+
+	// confirms a GetContentHash match, the faces are the same and every vertex is within the tolerance, normals within 1e-4
+	bool IfcGeometry::HasSameContent(const IfcGeometry &other, double tolerance) const
+	{
+		if (numPoints != other.numPoints || numFaces != other.numFaces || vertexData.size() != other.vertexData.size() || indexData != other.indexData) return false;
+		for (size_t i = 0; i < vertexData.size(); i += 6)
+		{
+			for (size_t j = 0; j < 3; j++) if (std::abs(vertexData[i + j] - other.vertexData[i + j]) > tolerance) return false;
+			for (size_t j = 3; j < 6; j++) if (std::abs(vertexData[i + j] - other.vertexData[i + j]) > 1e-4) return false;
+		}
+		return true;
+	}
+
 }
\ No newline at end of file
@@ -7,6 +7,7 @@
 #pragma once
 
 #include <vector>
+#include <array>
 #include <string>
 #include <glm/glm.hpp>
 
@@ -23,6 +24,7 @@ namespace webifc::geometry {
 		glm::dvec3 min = glm::dvec3(DBL_MAX, DBL_MAX, DBL_MAX);
 		glm::dvec3 max = glm::dvec3(-DBL_MAX, -DBL_MAX, -DBL_MAX);
 		bool normalized = false;
+		uint32_t vertexFormat = VERTEX_FLOAT;
 
 		uint32_t numPoints = 0;
 		uint32_t numFaces = 0;
@@ -30,10 +32,21 @@ namespace webifc::geometry {
 		glm::dvec3 GetExtent() const;	
 		void Normalize();
 		void AddComponent(IfcGeometry &g);
-		void AddPoint(glm::dvec4 &pt, glm::dvec3 &n);
-		void AddPoint(glm::dvec3 &pt, glm::dvec3 &n);
+		// degenerate input met while building geometry on this thread, counted instead of printed, the geometry processor
+		// reports it per element through the model's error handler
+		struct DegenerateInput
+		{
+			uint32_t nanPoints = 0;
+			uint32_t zeroAreaFaces = 0;
+		};
+		static thread_local DegenerateInput degenerateInput;
+
+		void Reserve(uint32_t points, uint32_t faces);
+		void AddPoint(const glm::dvec4 &pt, const glm::dvec3 &n);
+		void AddPoint(const glm::dvec3 &pt, const glm::dvec3 &n);
 		void AddFace(glm::dvec3 a, glm::dvec3 b, glm::dvec3 c);
 		void AddFace(uint32_t a, uint32_t b, uint32_t c);
+		void AddIndexedFaces(const std::vector<glm::dvec3> &points, const std::vector<uint32_t> &indices, double creaseAngle);
 		void ReverseFace(uint32_t index);
 		void ReverseFaces();
 		Face GetFace(uint32_t index) const;
@@ -44,10 +57,15 @@ namespace webifc::geometry {
 		uint32_t GetVertexData();
 		void AddGeometry(IfcGeometry geom);
 		uint32_t GetVertexDataSize();
+		std::array<double, 16> GetDequantizationMatrix() const;
+		void ReleaseDoubleVertexData();
 		uint32_t GetIndexData();
 		uint32_t GetIndexDataSize();
+		uint64_t GetContentHash(double tolerance) const;
+		bool HasSameContent(const IfcGeometry &other, double tolerance) const;
 
 		private:
+			uint32_t builtVertexFormat = VERTEX_FLOAT;
 			bool computeSafeNormal(const glm::dvec3 v1, const glm::dvec3 v2, const glm::dvec3 v3, glm::dvec3 &normal, double eps);
 	};
 
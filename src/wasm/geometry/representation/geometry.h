@@ -21,6 +21,19 @@ namespace webifc::geometry {
 
 	inline constexpr int VERTEX_FORMAT_SIZE_FLOATS = 6;
 
+	// layouts of the buffer GetVertexData builds, counted in 4 byte words per vertex
+	enum VertexFormat : uint32_t
+	{
+		VERTEX_FLOAT = 0,			// float32 position and normal
+		VERTEX_FLOAT_OCT = 1,		// float32 position, snorm16 octahedral normal
+		VERTEX_QUANTIZED_OCT = 2	// unorm16 position and padding, snorm16 octahedral normal, see GetDequantizationMatrix
+	};
+
+	inline constexpr uint32_t VertexFormatWords(uint32_t format)
+	{
+		return format == VERTEX_FLOAT_OCT ? 4 : format == VERTEX_QUANTIZED_OCT ? 3 : VERTEX_FORMAT_SIZE_FLOATS;
+	}
+
 	inline constexpr double EPS_SMALL = 1e-6;
 	inline static constexpr double EPS_TINY = 1e-9;
 
@@ -22,6 +22,25 @@ namespace webifc::parsing {
    { 
    _tokenStream = new IfcTokenStream(tapeSize,(memoryLimit/tapeSize));
    }  
+
+   // a reader shares the tape and line index of its source but has its own read cursor, so geometry can be read
+   // on several threads at once, the source must stay unmodified while readers are in use, see CanCreateReaders
+   IfcLoader::IfcLoader(const IfcLoader &source, utility::LoaderErrorHandler &errorHandler) : _schemaManager(source._schemaManager), _errorHandler(errorHandler), _index(source._index)
+   {
+   _tokenStream = new IfcTokenStream(*source._tokenStream);
+   }
+
+   // readers cannot reload chunks evicted by the memory limit, the data source may only be callable from the loading thread
+   bool IfcLoader::CanCreateReaders() const
+   {
+     return _tokenStream->IsFullyLoaded();
+   }
+
+   // frees the loader from the data source passed to LoadFile if every chunk of the tape is resident, see IfcTokenStream::DetachSource
+   bool IfcLoader::DetachSource()
+   {
+     return _tokenStream->DetachSource();
+   }
    
    const std::vector<uint32_t> IfcLoader::GetExpressIDsWithType(const uint32_t type) const
    { 
@@ -47,10 +66,13 @@ namespace webifc::parsing {
      return ret;
    }
    
-   void IfcLoader::LoadFile(const std::function<uint32_t(char *, size_t, size_t)> &requestData)
+   void IfcLoader::LoadFile(const std::function<uint32_t(char *, size_t, size_t)> &requestData, const std::function<bool(size_t, size_t)> &onProgress)
    { 
-     _tokenStream->SetTokenSource(requestData);
-     ParseLines();
+     _tokenStream->SetTokenSource(requestData, [&](size_t bytesRead)
+     {
+       ParseLines();
+       return onProgress ? onProgress(bytesRead, _lines.size()) : true;
+     });
    }
 
    IFC_SCHEMA IfcLoader::GetSchema() const
@@ -75,10 +97,13 @@ namespace webifc::parsing {
 
    }
    
-   void IfcLoader::LoadFile(std::istream &requestData)
+   void IfcLoader::LoadFile(std::istream &requestData, const std::function<bool(size_t, size_t)> &onProgress)
    { 
-     _tokenStream->SetTokenSource(requestData);
-     ParseLines();
+     _tokenStream->SetTokenSource(requestData, [&](size_t bytesRead)
+     {
+       ParseLines();
+       return onProgress ? onProgress(bytesRead, _lines.size()) : true;
+     });
    }
    
    void IfcLoader::SaveFile(const std::function<void(char *, size_t)> &outputData) const
@@ -165,6 +190,11 @@ namespace webifc::parsing {
               output << getAsStringWithBigE(_tokenStream->Read<double>());
               break;
             }
+            case IfcTokenType::INTEGER:
+            {
+              output << _tokenStream->Read<int32_t>();
+              break;
+            }
             default:
               break;
           }
@@ -256,6 +286,11 @@ namespace webifc::parsing {
               output << getAsStringWithBigE(_tokenStream->Read<double>());
               break;
             }
+            case IfcTokenType::INTEGER:
+            {
+              output << _tokenStream->Read<int32_t>();
+              break;
+            }
             default:
               break;
           }
@@ -294,10 +329,13 @@ namespace webifc::parsing {
   
    void IfcLoader::ParseLines() 
    {
-        uint32_t maxExpressId = 0;
-  			uint32_t currentIfcType = 0;
-  			uint32_t currentExpressID = 0;
-  			uint32_t currentTapeOffset = 0;
+        // called once per loaded tape chunk, a line may span two chunks so the parse state is kept between calls
+        uint32_t maxExpressId = GetMaxExpressId();
+        size_t firstNewLine = _lines.size();
+  			uint32_t &currentIfcType = _parseState.ifcType;
+  			uint32_t &currentExpressID = _parseState.expressID;
+  			uint32_t &currentTapeOffset = _parseState.tapeOffset;
+        _tokenStream->MoveTo(_parseState.readOffset);
   			while (!_tokenStream->IsAtEnd())
   			{
           IfcTokenType t = static_cast<IfcTokenType>(_tokenStream->Read<char>());
@@ -376,14 +414,73 @@ namespace webifc::parsing {
   					_tokenStream->Forward(sizeof(double));
   					break;
   				}
+  				case IfcTokenType::INTEGER:
+  				{
+  					_tokenStream->Forward(sizeof(int32_t));
+  					break;
+  				}
   				default:
   					break;
   				}
   			}
+        _parseState.readOffset = _tokenStream->GetReadOffset();
   			_expressIDToLine.resize(maxExpressId + 1);
-  			for (uint32_t i = 1; i <= _lines.size(); i++) _expressIDToLine[_lines[i-1].expressID] = i;
+  			for (size_t i = firstNewLine; i < _lines.size(); i++) _expressIDToLine[_lines[i].expressID] = i + 1;
    }
    
+   const std::vector<uint32_t> IfcLoader::GetLineReferences(const uint32_t expressID) const
+   {
+     std::vector<uint32_t> refs;
+     _tokenStream->MoveTo(_lines[ExpressIDToLineID(expressID)].tapeOffset);
+     _tokenStream->Read<char>(); // own ref
+     _tokenStream->Read<uint32_t>();
+     while (!_tokenStream->IsAtEnd())
+     {
+       IfcTokenType t = static_cast<IfcTokenType>(_tokenStream->Read<char>());
+       if (t == IfcTokenType::LINE_END) break;
+       switch (t)
+       {
+         case IfcTokenType::REF:
+           refs.push_back(_tokenStream->Read<uint32_t>());
+           break;
+         case IfcTokenType::STRING:
+         case IfcTokenType::ENUM:
+         case IfcTokenType::LABEL:
+           _tokenStream->ReadString();
+           break;
+         case IfcTokenType::REAL:
+           _tokenStream->Forward(sizeof(double));
+           break;
+         case IfcTokenType::INTEGER:
+           _tokenStream->Forward(sizeof(int32_t));
+           break;
+         default:
+           break;
+       }
+     }
+     return refs;
+   }
+
+   bool IfcLoader::IsReferenceClosureLoaded(const uint32_t expressID, std::unordered_set<uint32_t> &resolved) const
+   {
+     // resolved caches lines whose closure is already known to be complete, so repeated queries stay linear in the model size
+     if (resolved.count(expressID)) return true;
+     std::vector<uint32_t> stack = { expressID };
+     std::unordered_set<uint32_t> visited = { expressID };
+     while (!stack.empty())
+     {
+       uint32_t current = stack.back();
+       stack.pop_back();
+       if (!IsValidExpressID(current)) return false;
+       for (uint32_t ref : GetLineReferences(current))
+       {
+         if (!resolved.count(ref) && visited.insert(ref).second) stack.push_back(ref);
+       }
+     }
+     resolved.insert(visited.begin(), visited.end());
+     return true;
+   }
+
    size_t IfcLoader::GetNumLines() const
    { 
      return _lines.size();
@@ -403,7 +500,7 @@ namespace webifc::parsing {
    
    bool IfcLoader::IsValidExpressID(const uint32_t expressID) const
    {  
-   	 if (_expressIDToLine[expressID]==0) return false;
+   	 if (expressID >= _expressIDToLine.size() || _expressIDToLine[expressID]==0) return false;
      else return true;
    }
    
@@ -453,9 +550,16 @@ namespace webifc::parsing {
    
    double IfcLoader::GetDoubleArgument() const
    { 
-       _tokenStream->Read<char>(); // real type
+       if (_tokenStream->Read<char>() == IfcTokenType::INTEGER) return _tokenStream->Read<int32_t>();
        return _tokenStream->Read<double>();
    }
+
+   int32_t IfcLoader::GetIntArgument() const
+   { 
+       // integers written with a point are still accepted
+       if (_tokenStream->Read<char>() == IfcTokenType::REAL) return static_cast<int32_t>(_tokenStream->Read<double>());
+       return _tokenStream->Read<int32_t>();
+   }
    
    uint32_t IfcLoader::GetRefArgument() const
    { 
@@ -478,6 +582,12 @@ namespace webifc::parsing {
 		_tokenStream->MoveTo(tapeOffset);
 		return GetDoubleArgument();
 	}
+
+  int32_t IfcLoader::GetIntArgument(const uint32_t tapeOffset) const
+	{
+		_tokenStream->MoveTo(tapeOffset);
+		return GetIntArgument();
+	}
   
   void IfcLoader::UpdateLineTape(const uint32_t expressID, const uint32_t type, const uint32_t start, const uint32_t end)
   {
@@ -591,6 +701,10 @@ namespace webifc::parsing {
          {
            _tokenStream->Read<double>();
          }
+         else if (t == IfcTokenType::INTEGER)
+         {
+           _tokenStream->Read<int32_t>();
+         }
          else if (t == IfcTokenType::REF)
          {
            _tokenStream->Read<uint32_t>();
@@ -654,6 +768,10 @@ namespace webifc::parsing {
      			{
      				_tokenStream->Read<double>();
      			}
+     			else if (t == IfcTokenType::INTEGER)
+     			{
+     				_tokenStream->Read<int32_t>();
+     			}
      			else if (t == IfcTokenType::REF)
      			{
      				_tokenStream->Read<uint32_t>();
@@ -739,6 +857,11 @@ namespace webifc::parsing {
    			_tokenStream->Read<double>();
    			break;
    		}
+   		case IfcTokenType::INTEGER:
+   		{
+   			_tokenStream->Read<int32_t>();
+   			break;
+   		}
    		default:
    			break;
    		}
@@ -757,7 +880,7 @@ namespace webifc::parsing {
 
    double IfcLoader::GetOptionalDoubleParam(double defaultValue = 0) const
     {
-      if (GetTokenType() ==IfcTokenType::REAL)
+      if (IsNumber(GetTokenType()))
       {
         StepBack();
         return GetDoubleArgument();
@@ -6,8 +6,12 @@
 
 #include <vector>
 #include <unordered_map>
+#include <unordered_set>
 #include <istream>
 #include <set>
+#include <memory>
+#include <algorithm>
+#include <type_traits>
 
 #include "IfcTokenStream.h"
 #include "../utility/LoaderError.h"
@@ -37,11 +41,12 @@ namespace webifc::parsing
   
     public:
       IfcLoader(size_t tapeSize, size_t memoryLimit,utility::LoaderErrorHandler &errorHandler,schema::IfcSchemaManager &schemaManager);  
+      IfcLoader(const IfcLoader &source, utility::LoaderErrorHandler &errorHandler);
       ~IfcLoader();
       const std::vector<uint32_t> GetExpressIDsWithType(const uint32_t type) const;
       const std::vector<IfcHeaderLine> GetHeaderLinesWithType(const uint32_t type) const;
-      void LoadFile(const std::function<uint32_t(char *, size_t, size_t)> &requestData);
-      void LoadFile(std::istream &requestData);
+      void LoadFile(const std::function<uint32_t(char *, size_t, size_t)> &requestData, const std::function<bool(size_t, size_t)> &onProgress = nullptr);
+      void LoadFile(std::istream &requestData, const std::function<bool(size_t, size_t)> &onProgress = nullptr);
       void SaveFile(const std::function<void(char *, size_t)> &outputData) const;
       void SaveFile(std::ostream &outputData) const;
       size_t GetNumLines() const;
@@ -53,6 +58,8 @@ namespace webifc::parsing
       const IfcLine &GetLine(const uint32_t lineID) const;
       bool IsOpen() const;
       bool IsAtEnd() const;
+      bool CanCreateReaders() const;
+      bool DetachSource();
       void SetClosed();
       void MoveToLineArgument(const uint32_t lineID, const uint32_t argumentIndex) const;
       void MoveToHeaderLineArgument(const uint32_t lineID, const uint32_t argumentIndex) const;
@@ -61,6 +68,8 @@ namespace webifc::parsing
       double GetDoubleArgument() const;
       double GetOptionalDoubleParam(double defaultValue) const;
       double GetDoubleArgument(const uint32_t tapeOffset) const;
+      int32_t GetIntArgument() const;
+      int32_t GetIntArgument(const uint32_t tapeOffset) const;
       uint32_t GetRefArgument() const;
       uint32_t GetRefArgument(const uint32_t tapeOffset) const;
       uint32_t GetOptionalRefArgument() const;
@@ -70,6 +79,8 @@ namespace webifc::parsing
       const std::vector<std::vector<uint32_t>> GetSetListArgument() const;
       void MoveToArgumentOffset(const IfcLine &line, const uint32_t argumentIndex) const;
       void StepBack() const;
+      const std::vector<uint32_t> GetLineReferences(const uint32_t expressID) const;
+      bool IsReferenceClosureLoaded(const uint32_t expressID, std::unordered_set<uint32_t> &resolved) const;
       IFC_SCHEMA GetSchema() const;
       void Push(void *v, const uint64_t size);
       uint64_t GetTotalSize() const;
@@ -79,16 +90,68 @@ namespace webifc::parsing
       {
         _tokenStream->Push(input);
       }
+      // reads a list of number tuples such as the ((x,y,z),...) of a point list, argument argumentIndex of line, into out as T values,
+      // dim per tuple, Element being one or more of them like glm::dvec3 for points or uint32_t itself for a flat index list
+      template <typename T, typename Element> void ReadNumberTuples(const IfcLine &line, const uint32_t argumentIndex, const uint32_t dim, std::vector<Element> &out) const
+      {
+        static_assert(sizeof(Element) % sizeof(T) == 0, "elements are made of tuple values");
+        constexpr size_t valuesPerElement = sizeof(Element) / sizeof(T);
+        const size_t elementsPerTuple = dim / valuesPerElement;
+        constexpr size_t batchTuples = 1024;
+
+        MoveToArgumentOffset(line, argumentIndex);
+        // a list of reals has this many tuples, integers take less tape so their lists may grow the vector later
+        out.reserve(out.size() + (line.tapeEnd - _tokenStream->GetReadOffset()) / (2 + dim * (1 + sizeof(double))) * elementsPerTuple);
+        GetTokenType(); // list begin
+
+        while (true)
+        {
+          size_t first = out.size();
+          size_t room = out.capacity() - first >= elementsPerTuple ? std::min(batchTuples, (out.capacity() - first) / elementsPerTuple) : batchTuples;
+          out.resize(first + room * elementsPerTuple);
+          size_t tuples = _tokenStream->ReadNumberTuples(dim, reinterpret_cast<T *>(out.data() + first), room);
+          out.resize(first + tuples * elementsPerTuple);
+          if (tuples == room) continue;
+
+          // a tuple the bulk read stopped at, or the end of the list
+          if (GetTokenType() != IfcTokenType::SET_BEGIN) break;
+          out.resize(first + (tuples + 1) * elementsPerTuple);
+          T *values = reinterpret_cast<T *>(out.data() + first + tuples * elementsPerTuple);
+          for (uint32_t i = 0; i < dim; i++)
+          {
+            if constexpr (std::is_integral_v<T>) values[i] = static_cast<T>(GetIntArgument());
+            else values[i] = static_cast<T>(GetDoubleArgument());
+          }
+          GetTokenType(); // tuple end
+        }
+      }
 
     private:
       const schema::IfcSchemaManager &_schemaManager;
       utility::LoaderErrorHandler &_errorHandler;
       IfcTokenStream * _tokenStream;
-      std::vector<IfcLine> _lines;
-      std::vector<IfcHeaderLine> _headerLines;
-      std::vector<uint32_t> _expressIDToLine;
-      std::unordered_map<uint32_t, std::vector<uint32_t>> _ifcTypeToLineID;
-      std::unordered_map<uint32_t, std::vector<uint32_t>> _ifcTypeToHeaderLineID;
+      struct LineIndex
+      {
+        std::vector<IfcLine> lines;
+        std::vector<IfcHeaderLine> headerLines;
+        std::vector<uint32_t> expressIDToLine;
+        std::unordered_map<uint32_t, std::vector<uint32_t>> ifcTypeToLineID;
+        std::unordered_map<uint32_t, std::vector<uint32_t>> ifcTypeToHeaderLineID;
+      };
+      // shared with the readers created from this loader
+      std::shared_ptr<LineIndex> _index = std::make_shared<LineIndex>();
+      std::vector<IfcLine> &_lines = _index->lines;
+      std::vector<IfcHeaderLine> &_headerLines = _index->headerLines;
+      std::vector<uint32_t> &_expressIDToLine = _index->expressIDToLine;
+      std::unordered_map<uint32_t, std::vector<uint32_t>> &_ifcTypeToLineID = _index->ifcTypeToLineID;
+      std::unordered_map<uint32_t, std::vector<uint32_t>> &_ifcTypeToHeaderLineID = _index->ifcTypeToHeaderLineID;
+      struct
+      {
+        uint32_t ifcType = 0;
+        uint32_t expressID = 0;
+        uint32_t tapeOffset = 0;
+        size_t readOffset = 0;
+      } _parseState;
       void ParseLines();
       void ArgumentOffset(const uint32_t argumentIndex) const;      
 	};
@@ -43,6 +43,12 @@ namespace webifc::parsing
   {
     return _loaded;
   }
+
+  // a detached chunk is never cleared, like the chunks written with Push
+  void IfcTokenStream::IfcTokenChunk::Detach()
+  {
+    _fileStream = NULL;
+  }
   
   std::string_view IfcTokenStream::IfcTokenChunk::ReadString(const size_t ptr,const size_t size) 
   {
@@ -158,21 +164,35 @@ namespace webifc::parsing
         else if (c >= '0' && c <= '9')
         {
           bool negative = _fileStream->Prev() == '-';
+          bool integer = true;
           temp.clear();
 
           while ((_fileStream->Get() >= '0' && _fileStream->Get() <= '9') || (_fileStream->Get() == '.') || _fileStream->Get() == 'e' || _fileStream->Get() == 'E' || _fileStream->Get() == '-'|| _fileStream->Get() == '+')
           {
+            integer = integer && _fileStream->Get() >= '0' && _fileStream->Get() <= '9';
             temp.push_back(_fileStream->Get());
             _fileStream->Forward();
           }
 
-          const char* start = &(temp[0]);
-          const char* end = start;
-          double value = crack_atof(end, start + temp.size());
+          // indices and counts take four bytes on the tape instead of eight, up to nine digits always fit
+          if (integer && temp.size() <= 9)
+          {
+            int32_t value = 0;
+            for (const char digit : temp) value = value * 10 + (digit - '0');
+
+            Push<uint8_t>(IfcTokenType::INTEGER);
+            Push<int32_t>(negative ? -value : value);
+          }
+          else
+          {
+            const char* start = &(temp[0]);
+            const char* end = start;
+            double value = crack_atof(end, start + temp.size());
 
-          if (negative) value *= -1;
-          Push<uint8_t>(IfcTokenType::REAL);
-          Push<double>(value);
+            if (negative) value *= -1;
+            Push<uint8_t>(IfcTokenType::REAL);
+            Push<double>(value);
+          }
 
           // skip next advance
           continue;
@@ -4,6 +4,7 @@
  
 #include <vector>
 #include <istream>
+#include <algorithm>
 #include "IfcTokenStream.h"
 
 namespace webifc::parsing
@@ -16,27 +17,45 @@ namespace webifc::parsing
     _fileStream=NULL;
   }
 
-  void IfcTokenStream::SetTokenSource(const std::function<uint32_t(char *, size_t, size_t)> &requestData) 
+  // a reader over the same chunks with its own cursor, chunks are not loaded through it so the source
+  // must be fully loaded and must not be written to while the reader is in use
+  IfcTokenStream::IfcTokenStream(const IfcTokenStream &source)
+  :  _readPtr(source._readPtr), _currentChunk(source._currentChunk), _activeChunks(source._activeChunks), _chunkSize(source._chunkSize), _maxChunks(source._maxChunks), _sharedChunks(source._sharedChunks), _cChunk(source._cChunk), _fileStream(source._fileStream)
+  {
+  }
+
+  void IfcTokenStream::SetTokenSource(const std::function<uint32_t(char *, size_t, size_t)> &requestData, const std::function<bool(size_t)> &onChunkLoaded) 
   {
       _fileStream = new IfcFileStream(requestData,_chunkSize);
       size_t tokenOffset=0;
-      while (!_fileStream->IsAtEnd())
+      size_t fileOffset=0;
+      while (true)
       {
+          // the chunk callback may reload earlier chunks, which moves the file stream
+          if (_fileStream->GetRef()!=fileOffset) _fileStream->Go(fileOffset);
+          if (_fileStream->IsAtEnd()) break;
           checkMemory();
-          IfcTokenChunk chunk(_chunkSize,tokenOffset,_fileStream->GetRef(),_fileStream);
-          auto cSize = chunk.TokenSize();
-          tokenOffset+=cSize;
-          if (cSize > _chunkSize) _chunkSize = cSize;
+          IfcTokenChunk chunk(_chunkSize,tokenOffset,fileOffset,_fileStream);
+          fileOffset = _fileStream->GetRef();
+          tokenOffset+=chunk.TokenSize();
           _chunks.push_back(chunk);
           _activeChunks++;
+          if (onChunkLoaded)
+          {
+            _cChunk = &_chunks[_currentChunk];
+            Forward(0);
+            if (!onChunkLoaded(fileOffset)) break;
+          }
       }
-      _cChunk = &_chunks.front();
+      _currentChunk=0;
+      _readPtr=0;
+      if (!_chunks.empty()) _cChunk = &_chunks.front();
       _fileStream->Clear();
   }
 
-  void IfcTokenStream::SetTokenSource(std::istream &requestData)
+  void IfcTokenStream::SetTokenSource(std::istream &requestData, const std::function<bool(size_t)> &onChunkLoaded)
   { 
-     SetTokenSource([&](char* dest, size_t sourceOffset, size_t destSize) { requestData.seekg(sourceOffset); requestData.read(dest, destSize); return requestData.gcount();});
+     SetTokenSource([&](char* dest, size_t sourceOffset, size_t destSize) { requestData.seekg(sourceOffset); requestData.read(dest, destSize); return requestData.gcount();}, onChunkLoaded);
   }
   
   std::string_view IfcTokenStream::ReadString() 
@@ -66,9 +85,11 @@ namespace webifc::parsing
   
   void IfcTokenStream::MoveTo(const size_t pos)
   {
-      _currentChunk = pos / _chunkSize;
+      // chunks are not all the same size, find the last one starting at or before pos
+      auto it = std::upper_bound(_chunks.begin(), _chunks.end(), pos, [](const size_t p, IfcTokenChunk &chunk) { return p < chunk.GetTokenRef(); });
+      _currentChunk = it == _chunks.begin() ? 0 : std::distance(_chunks.begin(), it) - 1;
       _cChunk = &_chunks[_currentChunk];
-      _readPtr = pos % _chunkSize;
+      _readPtr = pos - _cChunk->GetTokenRef();
   }
   
   void IfcTokenStream::checkMemory()
@@ -110,6 +131,23 @@ namespace webifc::parsing
     return _chunks.back().TokenSize() + _chunks.back().GetTokenRef();
   }
   
+  bool IfcTokenStream::IsFullyLoaded()
+  {
+    return std::all_of(_chunks.begin(), _chunks.end(), [](IfcTokenChunk &chunk) { return chunk.IsLoaded(); });
+  }
+
+  // once every chunk is in memory the file is not read again, the chunks are kept from then on instead of being
+  // evicted and reloaded, so the caller may free the data source. returns false, and keeps the source, otherwise
+  bool IfcTokenStream::DetachSource()
+  {
+    if (_fileStream == NULL) return true;
+    if (!IsFullyLoaded()) return false;
+    for (auto &chunk : _chunks) chunk.Detach();
+    delete _fileStream;
+    _fileStream = NULL;
+    return true;
+  }
+
   void IfcTokenStream::Back()
   {
       if (_readPtr == 0 ) 
@@ -131,7 +169,7 @@ namespace webifc::parsing
   
   size_t IfcTokenStream::GetReadOffset() 
   {
-      return _currentChunk*_chunkSize + _readPtr;
+      return _cChunk->GetTokenRef() + _readPtr;
   }
   
 }
\ No newline at end of file
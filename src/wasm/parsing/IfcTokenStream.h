@@ -9,6 +9,8 @@
 #include <iostream>
 #include <functional>
 #include <cstring>
+#include <memory>
+#include <cstdint>
  
 namespace webifc::parsing
 {
@@ -24,16 +26,24 @@ namespace webifc::parsing
     EMPTY,
     SET_BEGIN,
     SET_END,
-    LINE_END
+    LINE_END,
+    INTEGER
   };
+
+  // numbers written without a point or exponent are INTEGER tokens, any number can be read with GetDoubleArgument
+  inline bool IsNumber(const IfcTokenType t)
+  {
+    return t == REAL || t == INTEGER;
+  }
   
   
   class IfcTokenStream 
   {
       public:
         IfcTokenStream(const size_t chunkSize, const size_t maxChunks);
-        void SetTokenSource(const std::function<uint32_t(char *, size_t, size_t)> &requestData);
-        void SetTokenSource(std::istream &requestData);
+        IfcTokenStream(const IfcTokenStream &source);
+        void SetTokenSource(const std::function<uint32_t(char *, size_t, size_t)> &requestData, const std::function<bool(size_t)> &onChunkLoaded = nullptr);
+        void SetTokenSource(std::istream &requestData, const std::function<bool(size_t)> &onChunkLoaded = nullptr);
         template <typename T> T Read()
         {
           T v =  _cChunk->Read<T>(_readPtr);
@@ -47,11 +57,19 @@ namespace webifc::parsing
         void Push(void *v, const size_t size);
         void Forward(const size_t size);
         std::string_view ReadString();
+        template <typename T> size_t ReadNumberTuples(const uint32_t dim, T *out, const size_t maxTuples)
+        {
+          size_t tuples = _cChunk->ReadNumberTuples(_readPtr, dim, out, maxTuples);
+          Forward(0);
+          return tuples;
+        }
         void Back();
         bool IsAtEnd();
         void MoveTo(const size_t pos);
         size_t GetReadOffset();
         size_t GetTotalSize();
+        bool IsFullyLoaded();
+        bool DetachSource();
 
       private:
         void checkMemory();
@@ -89,6 +107,7 @@ namespace webifc::parsing
             	IfcTokenChunk(const size_t chunkSize, const size_t startRef, const size_t fileStartRef, IfcFileStream *_fileStream);
               bool Clear();
               bool IsLoaded();
+              void Detach();
               size_t TokenSize();
               size_t GetTokenRef();
               void Push(void *v, const size_t size);
@@ -104,6 +123,41 @@ namespace webifc::parsing
               {
                 Push(&input,sizeof(T));
               }
+              // decodes whole (n,...,n) tuples of dim REAL or INTEGER tokens from ptr on in one pass over the chunk, it stops
+              // before a tuple holding other tokens or running into the next chunk, which is then left to the token by token reads
+              template <typename T> size_t ReadNumberTuples(size_t &ptr, const uint32_t dim, T *out, const size_t maxTuples)
+              {
+                if (!_loaded) Load();
+                size_t tuples = 0;
+                while (tuples < maxTuples && ptr < _currentSize && _chunkData[ptr] == IfcTokenType::SET_BEGIN)
+                {
+                  size_t p = ptr + 1;
+                  T *values = out + tuples * dim;
+                  uint32_t i = 0;
+                  for (; i < dim && p < _currentSize; i++)
+                  {
+                    if (_chunkData[p] == IfcTokenType::REAL && p + 1 + sizeof(double) <= _currentSize)
+                    {
+                      double v;
+                      std::memcpy(&v, _chunkData + p + 1, sizeof(double));
+                      values[i] = static_cast<T>(v);
+                      p += 1 + sizeof(double);
+                    }
+                    else if (_chunkData[p] == IfcTokenType::INTEGER && p + 1 + sizeof(int32_t) <= _currentSize)
+                    {
+                      int32_t v;
+                      std::memcpy(&v, _chunkData + p + 1, sizeof(int32_t));
+                      values[i] = static_cast<T>(v);
+                      p += 1 + sizeof(int32_t);
+                    }
+                    else break;
+                  }
+                  if (i < dim || p >= _currentSize || _chunkData[p] != IfcTokenType::SET_END) break;
+                  ptr = p + 1;
+                  tuples++;
+                }
+                return tuples;
+              }
             private:
               void Load();
               bool _loaded=false;
@@ -114,7 +168,9 @@ namespace webifc::parsing
             	uint8_t *_chunkData;
               IfcFileStream *_fileStream;
         };
-        std::vector<IfcTokenChunk> _chunks;
+        // shared with the streams copied from this one, which only differ by their read cursor
+        std::shared_ptr<std::vector<IfcTokenChunk>> _sharedChunks = std::make_shared<std::vector<IfcTokenChunk>>();
+        std::vector<IfcTokenChunk> &_chunks = *_sharedChunks;
         IfcTokenChunk * _cChunk;
         IfcFileStream * _fileStream;
   };
@@ -1,6 +1,7 @@
 #include <TinyCppTest.hpp>
 #include <glm/glm.hpp>
 #include "io_helpers.h"
+#include "../utility/ScratchArena.h"
 
 TEST (TriangleAreaTest)
 {
@@ -10,6 +11,24 @@ TEST (TriangleAreaTest)
 	ASSERT_EQ_EPS (webifc::geometry::areaOfTriangle (a, b, c), 0.5, webifc::geometry::EPS_TINY);
 }
 
+TEST (ScratchArenaTest)
+{
+	auto &arena = webifc::utility::ScratchArena::ForThisThread();
+	arena.Reset();
+	{
+		webifc::utility::ScratchVector<webifc::utility::ScratchVector<double>> rings(2);
+		for (int i = 0; i < 100000; i++) rings[i % 2].push_back(i);
+		ASSERT_EQ (rings[1][1], 3.0);
+		ASSERT_EQ (reinterpret_cast<uintptr_t>(rings[0].data()) % alignof(double), size_t(0));
+	}
+	ASSERT_EQ (arena.Used() >= 100000 * sizeof(double), true);
+
+	size_t reserved = arena.Reserved();
+	arena.Reset();
+	ASSERT_EQ (arena.Used(), size_t(0));
+	ASSERT_EQ (arena.Reserved(), reserved);
+}
+
 TEST(NewTest)
 {
 	// load model
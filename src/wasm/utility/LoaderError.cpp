@@ -20,6 +20,12 @@ namespace webifc::utility
         _errors.clear();
     }
 
+    // errors of another handler were already logged when reported, they are only appended
+    void LoaderErrorHandler::MergeErrors(const LoaderErrorHandler &other)
+    {
+        _errors.insert(_errors.end(), other._errors.begin(), other._errors.end());
+    }
+
     const std::vector<LoaderError>& LoaderErrorHandler::GetErrors() const
     {
         std::vector<LoaderError> output(_errors);
@@ -16,7 +16,8 @@ namespace webifc::utility
 	UNSPECIFIED,
 	PARSING,
 	BOOL_ERROR,
-	UNSUPPORTED_TYPE
+	UNSUPPORTED_TYPE,
+	DEGENERATE_GEOMETRY
 	};
 
 	class LoaderError
@@ -35,6 +36,7 @@ namespace webifc::utility
 		public:
 			void ReportError(const LoaderErrorType t = LoaderErrorType::UNSPECIFIED, const std::string m = "", const uint32_t e = 0, const uint32_t type = 0);
 			void ClearErrors();
+			void MergeErrors(const LoaderErrorHandler &other);
 			const std::vector<LoaderError> &GetErrors() const;
 		private:
 			std::vector<LoaderError> _errors;
@@ -2,6 +2,10 @@
  * License, v. 2.0. If a copy of the MPL was not distributed with this
  * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
  
+#pragma once
+
+#include <cstdint>
+
 namespace webifc::utility
 {
 	
@@ -12,8 +16,22 @@ namespace webifc::utility
 		int CIRCLE_SEGMENTS_LOW = 5;
 		int CIRCLE_SEGMENTS_MEDIUM = 8;
 		int CIRCLE_SEGMENTS_HIGH = 12;
-		int BOOL_ABORT_THRESHOLD = 10000; // 10k verts
+		double CURVE_MAX_DEVIATION = 0; // metres a chord may stray from its circle, arc, ellipse or B-spline curve, or a triangle from its B-spline surface, with CURVE_MAX_ANGLE 0 too every circle gets CIRCLE_SEGMENTS_HIGH points
+		double CURVE_MAX_ANGLE = 0; // degrees a single segment of a curve may turn, 0 does not limit it
+		uint32_t CURVE_MIN_SEGMENTS = 4; // segments of a full circle at least, arcs get their share
+		uint32_t CURVE_MAX_SEGMENTS = 256; // segments of a full circle or B-spline curve at most, arcs get their share
+		int BOOL_ABORT_THRESHOLD = 0; // combined points of two operands above which a subtraction is skipped, e.g. 10k verts, 0 disables it
+		uint32_t BOOL_TIME_BUDGET = 0; // milliseconds of boolean operations per element, booleans started past it are skipped, 0 disables it
+		bool BOOL_MERGE_OPERANDS = false; // voids with disjoint boxes are subtracted in one boolean, false subtracts them one by one, off until BoolBenchmark shows a gain
+		double CREASE_ANGLE = 30; // degrees, faces of triangulated face sets share vertices unless their normals differ by more
+    	uint32_t VERTEX_FORMAT = 0; // layout of GetVertexData, 0 float positions and normals, 1 float positions and octahedral normals, 2 16 bit quantized positions and octahedral normals
+    	bool KEEP_DOUBLE_VERTICES = true; // false frees the double precision vertices of delivered geometries once their output buffer is built
     	uint32_t TAPE_SIZE = 67108864 ; // probably no need for anyone other than web-ifc devs to change this
     	uint32_t MEMORY_LIMIT =  3221225472;
+    	uint32_t GEOMETRY_CACHE_SIZE = 268435456; // bytes of mapped representation geometry kept across elements, 0 disables the cache, the element workers split it equally
+    	double GEOMETRY_DEDUPLICATION_TOLERANCE = 0; // instanced streaming shares geometries whose normalized vertices agree within this distance, hashed on a grid of this size first, 0 disables it
+    	uint32_t GEOMETRY_THREADS = 0; // threads meshing elements in the multi-threaded build, 0 uses all cores, 1 meshes on the calling thread, capped to the core count
+    	bool STREAM_IN_ORDER = true; // with several geometry threads, false delivers meshes as they complete instead of in element order
+    	uint32_t BREP_PARALLEL_FACES = 10000; // shells with at least this many faces are triangulated on GEOMETRY_THREADS threads when meshed outside the element workers, 0 disables it
 	};
 }
\ No newline at end of file
@@ -0,0 +1,71 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#include <algorithm>
+#include "ScratchArena.h"
+
+namespace webifc::utility
+{
+
+  constexpr size_t MIN_BLOCK_SIZE = 64 * 1024;
+  // blocks beyond this are freed on reset, so one huge element does not pin its scratch memory for the rest of the model
+  constexpr size_t MAX_RETAINED_SIZE = 16 * 1024 * 1024;
+
+  ScratchArena &ScratchArena::ForThisThread()
+  {
+    thread_local ScratchArena arena;
+    return arena;
+  }
+
+  void *ScratchArena::Allocate(size_t bytes, size_t alignment)
+  {
+    while (_block < _blocks.size())
+    {
+      Block &block = _blocks[_block];
+      size_t start = (reinterpret_cast<uintptr_t>(block.data.get()) + _offset + alignment - 1) / alignment * alignment - reinterpret_cast<uintptr_t>(block.data.get());
+      if (start + bytes <= block.size)
+      {
+        _used += start + bytes - _offset;
+        _offset = start + bytes;
+        return block.data.get() + start;
+      }
+      _block++;
+      _offset = 0;
+    }
+
+    // blocks double so an element needs O(log n) of them, and a request larger than that gets a block of its own
+    size_t size = std::max(bytes + alignment, _blocks.empty() ? MIN_BLOCK_SIZE : _blocks.back().size * 2);
+    _blocks.push_back({std::make_unique<std::byte[]>(size), size});
+    _block = _blocks.size() - 1;
+    _offset = 0;
+    return Allocate(bytes, alignment);
+  }
+
+  void ScratchArena::Reset()
+  {
+    size_t retained = 0;
+    size_t kept = 0;
+    while (kept < _blocks.size() && retained + _blocks[kept].size <= MAX_RETAINED_SIZE)
+    {
+      retained += _blocks[kept++].size;
+    }
+    _blocks.resize(kept);
+    _block = 0;
+    _offset = 0;
+    _used = 0;
+  }
+
+  size_t ScratchArena::Used() const
+  {
+    return _used;
+  }
+
+  size_t ScratchArena::Reserved() const
+  {
+    size_t size = 0;
+    for (auto &block : _blocks) size += block.size;
+    return size;
+  }
+
+}
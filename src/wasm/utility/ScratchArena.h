@@ -0,0 +1,65 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace webifc::utility
+{
+
+  // monotonic arena for scratch data that dies with the element being meshed, one per thread so parallel workers never share it
+  // allocation bumps a pointer and deallocation does nothing, Reset() hands every block back at once when the element is done
+  class ScratchArena
+  {
+    public:
+      static ScratchArena &ForThisThread();
+
+      void *Allocate(size_t bytes, size_t alignment);
+      // only valid when nothing allocated from the arena is still in use
+      void Reset();
+      size_t Used() const;
+      size_t Reserved() const;
+
+    private:
+      struct Block
+      {
+        std::unique_ptr<std::byte[]> data;
+        size_t size;
+      };
+
+      std::vector<Block> _blocks;
+      size_t _block = 0;
+      size_t _offset = 0;
+      size_t _used = 0;
+  };
+
+  // standard allocator over the arena of the thread that creates it, for containers that never outlive the current element
+  template <typename T>
+  struct ScratchAllocator
+  {
+    using value_type = T;
+
+    ScratchArena *arena;
+
+    ScratchAllocator() : arena(&ScratchArena::ForThisThread()) {}
+    template <typename U>
+    ScratchAllocator(const ScratchAllocator<U> &other) : arena(other.arena) {}
+
+    T *allocate(size_t n) { return static_cast<T *>(arena->Allocate(n * sizeof(T), alignof(T))); }
+    void deallocate(T *, size_t) {}
+
+    template <typename U>
+    bool operator==(const ScratchAllocator<U> &other) const { return arena == other.arena; }
+    template <typename U>
+    bool operator!=(const ScratchAllocator<U> &other) const { return arena != other.arena; }
+  };
+
+  template <typename T>
+  using ScratchVector = std::vector<T, ScratchAllocator<T>>;
+
+}
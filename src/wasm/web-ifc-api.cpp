@@ -7,6 +7,18 @@
 #include <stack>
 #include <sstream>
 #include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <atomic>
+#include <thread>
+#include <condition_variable>
+#include <algorithm>
+#include <cstring>
+#include <cstdlib>
+#include <unordered_set>
+#include <unordered_map>
+#include <map>
+#include <tuple>
 
 #include <emscripten/bind.h>
 
@@ -19,24 +31,84 @@
 #include "version.h"
 
 
+// reads an argument holding either a single reference or a set of references
+std::vector<uint32_t> GetRefsArgument(webifc::parsing::IfcLoader * loader, const webifc::parsing::IfcLine &line, uint32_t argumentIndex)
+{
+    std::vector<uint32_t> refs;
+    loader->MoveToArgumentOffset(line, argumentIndex);
+    auto t = loader->GetTokenType();
+    loader->StepBack();
+    if (t == webifc::parsing::IfcTokenType::REF)
+    {
+        refs.push_back(loader->GetRefArgument());
+    }
+    else if (t == webifc::parsing::IfcTokenType::SET_BEGIN)
+    {
+        for (auto offset : loader->GetSetArgument())
+        {
+            if (loader->GetTokenType(offset) == webifc::parsing::IfcTokenType::REF) refs.push_back(loader->GetRefArgument(offset));
+        }
+    }
+    return refs;
+}
+
+// threads meshing may use, 1 in the single threaded build. the worker pool is sized to the core count (PTHREAD_POOL_SIZE) and a
+// thread started beyond it waits for one to return, which those started before it never do, so more are never asked for
+uint32_t GetGeometryThreads(const webifc::utility::LoaderSettings &settings)
+{
+#ifdef __EMSCRIPTEN_PTHREADS__
+    uint32_t cores = std::max<uint32_t>(1, std::thread::hardware_concurrency());
+    return settings.GEOMETRY_THREADS > 0 ? std::min(settings.GEOMETRY_THREADS, cores) : cores;
+#else
+    return 1;
+#endif
+}
+
 struct ModelInfo
 {
     public:
-        ModelInfo(webifc::utility::LoaderSettings _settings, webifc::schema::IfcSchemaManager &_schemaManager) : schemaManager(_schemaManager), settings(_settings)
+        ModelInfo(webifc::schema::IfcSchemaManager &_schemaManager) : schemaManager(_schemaManager)
+        {
+        }
+
+        ~ModelInfo()
+        {
+            Close();
+        }
+
+        void Open(webifc::utility::LoaderSettings _settings)
         {
+            settings = _settings;
             errorHandler = new webifc::utility::LoaderErrorHandler();
             loader = new webifc::parsing::IfcLoader(_settings.TAPE_SIZE,_settings.MEMORY_LIMIT,*errorHandler,schemaManager);
         }
-        
+
         webifc::geometry::IfcGeometryProcessor * GetGeometryLoader()
         {
-            if (geometryLoader==nullptr)
+            std::lock_guard<std::mutex> guard(geometryLoaderMutex);
+            if (geometryLoader==nullptr && loader!=nullptr)
             {
-                geometryLoader = new webifc::geometry::IfcGeometryProcessor(*loader, *errorHandler,schemaManager,settings.CIRCLE_SEGMENTS_HIGH,settings.COORDINATE_TO_ORIGIN);
+                geometryLoader = new webifc::geometry::IfcGeometryProcessor(*loader, *errorHandler,schemaManager,settings,GetGeometryThreads(settings));
             }
             return geometryLoader;
         }
         
+        // drops the geometry processor so the next one sees relationships indexed since, the coordination matrix is kept so meshes stay in one frame
+        // and the boolean timings so the report covers the whole model
+        void ResetGeometryLoader()
+        {
+            std::lock_guard<std::mutex> guard(geometryLoaderMutex);
+            if (geometryLoader==nullptr) return;
+            bool coordinated = geometryLoader->IsCoordinated();
+            glm::dmat4 coordinationMatrix = geometryLoader->GetCoordinationMatrix();
+            auto slowestBools = geometryLoader->GetSlowestBools();
+            geometryWorkers.clear();
+            delete geometryLoader;
+            geometryLoader = new webifc::geometry::IfcGeometryProcessor(*loader, *errorHandler,schemaManager,settings,GetGeometryThreads(settings));
+            if (coordinated) geometryLoader->SetCoordinationMatrix(coordinationMatrix);
+            geometryLoader->AddBoolTimings(slowestBools);
+        }
+
         webifc::utility::LoaderErrorHandler * GetErrorHanlder()
         {
             return errorHandler;
@@ -47,23 +119,225 @@ struct ModelInfo
             return loader;
         }
 
+        bool IsOpen() const
+        {
+            return loader!=nullptr;
+        }
+
+        using InverseIndex = std::unordered_map<uint32_t, std::vector<uint32_t>>;
+
+        // maps the objects referenced at one argument of a relationship type to the objects referenced at another,
+        // e.g. related objects to their relating object, built on first use and dropped whenever lines change
+        const InverseIndex &GetInverseIndex(uint32_t relationshipType, uint32_t relatedArgument, uint32_t relatingArgument)
+        {
+            auto key = std::make_tuple(relationshipType, relatedArgument, relatingArgument);
+            auto it = inverseIndexes.find(key);
+            if (it != inverseIndexes.end()) return it->second;
+
+            auto &index = inverseIndexes[key];
+            for (auto relID : loader->GetExpressIDsWithType(relationshipType))
+            {
+                auto &line = loader->GetLine(loader->ExpressIDToLineID(relID));
+                auto relating = GetRefsArgument(loader, line, relatingArgument);
+                for (auto related : GetRefsArgument(loader, line, relatedArgument))
+                {
+                    auto &entry = index[related];
+                    entry.insert(entry.end(), relating.begin(), relating.end());
+                }
+            }
+            return index;
+        }
+
+        // called whenever lines change, drops the relationship indexes and the geometry caches derived from line contents,
+        // the workers go too since their readers only see the lines there were when they were created
+        void InvalidateCaches()
+        {
+            inverseIndexes.clear();
+            std::lock_guard<std::mutex> guard(geometryLoaderMutex);
+            if (geometryLoader!=nullptr) geometryLoader->ClearCaches();
+            geometryWorkers.clear();
+        }
+
+        // appending lines to the tape only outdates the inverse index, placements, profiles and workers stay valid
+        void InvalidateInverseIndexes()
+        {
+            inverseIndexes.clear();
+        }
+
+        // a geometry processor for each meshing thread, with its own reader on the tape and error buffer
+        struct GeometryWorker
+        {
+            webifc::utility::LoaderErrorHandler errorHandler;
+            std::unique_ptr<webifc::parsing::IfcLoader> reader;
+            std::unique_ptr<webifc::geometry::IfcGeometryProcessor> processor;
+        };
+
+        // created on first use and kept across GenerateMeshes calls until lines change or the geometry processor is reset,
+        // the representation cache budget is split between them. empty if the tape can't be shared with readers yet
+        std::vector<std::unique_ptr<GeometryWorker>> &GetGeometryWorkers()
+        {
+            std::lock_guard<std::mutex> guard(geometryLoaderMutex);
+            if (geometryWorkers.empty() && loader!=nullptr && loader->CanCreateReaders())
+            {
+                uint32_t threads = GetGeometryThreads(settings);
+                webifc::utility::LoaderSettings workerSettings = settings;
+                workerSettings.GEOMETRY_CACHE_SIZE = settings.GEOMETRY_CACHE_SIZE / threads;
+                for (uint32_t t = 0; t < threads; t++)
+                {
+                    auto worker = std::make_unique<GeometryWorker>();
+                    worker->reader = std::make_unique<webifc::parsing::IfcLoader>(*loader, worker->errorHandler);
+                    // the threads are all busy with elements already, so large shells are not split further
+                    worker->processor = std::make_unique<webifc::geometry::IfcGeometryProcessor>(*worker->reader, worker->errorHandler, schemaManager, workerSettings);
+                    geometryWorkers.push_back(std::move(worker));
+                }
+            }
+            return geometryWorkers;
+        }
+
+        // set while worker threads read the tape, lines must not be written and the model not be closed until they are done
+        bool IsMeshingInParallel() const
+        {
+            return meshingInParallel;
+        }
+
+        void SetMeshingInParallel(bool value)
+        {
+            meshingInParallel = value;
+        }
+
+        // geometry buffers handed to the client as heap views, they outlive the processor's Clear() until released
+        struct PinnedGeometry
+        {
+            uint32_t geometryExpressID;
+            uint32_t vertexFormat;
+            std::array<double, 16> dequantizationMatrix;
+            std::vector<float> vertexData;
+            std::vector<uint32_t> indexData;
+        };
+
+        // builds the buffer the client reads in the configured vertex format, dropping the doubles unless the settings keep them
+        void PrepareVertexData(webifc::geometry::IfcGeometry &geometry)
+        {
+            geometry.vertexFormat = settings.VERTEX_FORMAT;
+            geometry.GetVertexData();
+            if (!settings.KEEP_DOUBLE_VERTICES) geometry.ReleaseDoubleVertexData();
+        }
+
+        // nothing is copied, the float vertex and index buffers are moved into the pin and the processor's geometry is
+        // left empty until its element is meshed again, the double vertices, if kept, are dropped with it.
+        // A mesh can place the same geometry more than once, pinning the emptied geometry again returns the live pin
+        uint32_t PinGeometry(uint32_t geometryExpressID, webifc::geometry::IfcGeometry &geometry)
+        {
+            auto pinnedBefore = pinByGeometry.find(geometryExpressID);
+            if (pinnedBefore != pinByGeometry.end() && geometry.numPoints == 0 && geometry.indexData.empty())
+            {
+                return pinnedBefore->second;
+            }
+
+            PinnedGeometry pinned;
+            PrepareVertexData(geometry);
+            pinned.geometryExpressID = geometryExpressID;
+            pinned.vertexFormat = geometry.vertexFormat;
+            pinned.dequantizationMatrix = geometry.GetDequantizationMatrix();
+            pinned.vertexData = std::move(geometry.fvertexData);
+            pinned.indexData = std::move(geometry.indexData);
+            geometry = webifc::geometry::IfcGeometry();
+            uint32_t handle = nextPinHandle++;
+            pinnedGeometries.emplace(handle, std::move(pinned));
+            pinByGeometry[geometryExpressID] = handle;
+            return handle;
+        }
+
+        const PinnedGeometry * GetPinnedGeometry(uint32_t handle) const
+        {
+            auto it = pinnedGeometries.find(handle);
+            return it == pinnedGeometries.end() ? nullptr : &it->second;
+        }
+
+        void ReleaseGeometry(uint32_t handle)
+        {
+            auto it = pinnedGeometries.find(handle);
+            if (it == pinnedGeometries.end()) return;
+            auto pinnedBefore = pinByGeometry.find(it->second.geometryExpressID);
+            if (pinnedBefore != pinByGeometry.end() && pinnedBefore->second == handle) pinByGeometry.erase(pinnedBefore);
+            pinnedGeometries.erase(it);
+        }
+
+        // outcome of the last instanced stream, geometries found identical to an earlier one are counted as duplicates
+        struct DeduplicationStats
+        {
+            uint32_t uniqueGeometries = 0;
+            uint32_t duplicateGeometries = 0;
+            double bytesSaved = 0;
+        };
+
+        DeduplicationStats deduplicationStats;
+
+        const webifc::utility::LoaderSettings &GetSettings() const
+        {
+            return settings;
+        }
+
+        // takes over a malloc'ed copy of the file the loader reads from, it reloads evicted tape chunks from it until the model is closed
+        void AdoptSource(char *data)
+        {
+            source.reset(data);
+        }
+
+        // frees the adopted file once the whole tape is resident, the copy is only kept if chunks were evicted while loading
+        void ReleaseSourceIfLoaded()
+        {
+            if (source && loader != nullptr && loader->DetachSource()) source.reset();
+        }
+
         void Close()
         {
+            pinnedGeometries.clear();
+            pinByGeometry.clear();
+            deduplicationStats = {};
+            inverseIndexes.clear();
+            geometryWorkers.clear();
             delete geometryLoader;
             geometryLoader=nullptr;
             delete loader;
             loader=nullptr;
+            source.reset();
+            delete errorHandler;
+            errorHandler=nullptr;
         }
 
+        // the tape has a single read cursor, so only calls that never move it (index lookups) may share this lock,
+        // everything that reads arguments, builds geometry or writes lines must hold it exclusively
+        std::shared_mutex mutex;
+
     private:
         webifc::schema::IfcSchemaManager &schemaManager;
         webifc::utility::LoaderSettings settings;
         webifc::parsing::IfcLoader * loader=nullptr;
         webifc::geometry::IfcGeometryProcessor * geometryLoader=nullptr;
+        std::vector<std::unique_ptr<GeometryWorker>> geometryWorkers;
+        bool meshingInParallel = false;
         webifc::utility::LoaderErrorHandler * errorHandler=nullptr;
+        std::mutex geometryLoaderMutex;
+        std::map<std::tuple<uint32_t, uint32_t, uint32_t>, InverseIndex> inverseIndexes;
+        std::unordered_map<uint32_t, PinnedGeometry> pinnedGeometries;
+        // latest live pin of each geometry express ID
+        std::unordered_map<uint32_t, uint32_t> pinByGeometry;
+        uint32_t nextPinHandle = 1;
+        struct FreeSource
+        {
+            void operator()(char *data) const { free(data); }
+        };
+        std::unique_ptr<char, FreeSource> source;
 };
 
-std::vector<ModelInfo> models;
+using ReadLock = std::shared_lock<std::shared_mutex>;
+using WriteLock = std::unique_lock<std::shared_mutex>;
+
+// model slots are never deallocated, a closed slot is recycled by the next CreateModel, so ModelInfo pointers stay valid for the lifetime of the module
+std::vector<std::unique_ptr<ModelInfo>> models;
+std::vector<uint32_t> freeModelIDs;
+std::shared_mutex modelsMutex;
 webifc::schema::IfcSchemaManager schemaManager;
 
 #ifdef __EMSCRIPTEN_PTHREADS__
@@ -72,11 +346,18 @@ webifc::schema::IfcSchemaManager schemaManager;
     constexpr bool MT_ENABLED = false;
 #endif
 
-bool shown_version_header = false;
+std::once_flag shown_version_header;
+
+ModelInfo * GetModel(uint32_t modelID)
+{
+    ReadLock lock(modelsMutex);
+    if (modelID >= models.size()) return nullptr;
+    return models[modelID].get();
+}
 
 int CreateModel(webifc::utility::LoaderSettings settings)
 {
-    if (!shown_version_header)
+    std::call_once(shown_version_header, []()
     {
         std::stringstream str;
         str << "web-ifc: "<< WEB_IFC_VERSION_NUMBER << " threading: " << (MT_ENABLED ? "enabled" : "disabled");
@@ -84,18 +365,37 @@ int CreateModel(webifc::utility::LoaderSettings settings)
         for (auto schema : schemaManager.GetAvailableSchemas())  str << schemaManager.GetSchemaName(schema)<<",";
         str << "]";
         webifc::utility::log::info(str.str());
-        shown_version_header = true;
+    });
+
+    uint32_t modelID;
+    ModelInfo * model;
+    {
+        WriteLock lock(modelsMutex);
+        if (!freeModelIDs.empty())
+        {
+            modelID = freeModelIDs.back();
+            freeModelIDs.pop_back();
+        }
+        else
+        {
+            modelID = models.size();
+            models.push_back(std::make_unique<ModelInfo>(schemaManager));
+        }
+        model = models[modelID].get();
     }
 
-    models.emplace_back(settings,schemaManager);
-    return models.size()-1;
+    WriteLock lock(model->mutex);
+    model->Open(settings);
+    return modelID;
 }
 
 int OpenModel(webifc::utility::LoaderSettings settings, emscripten::val callback)
 {
     auto modelID = CreateModel(settings);
-    
-    models[modelID].GetLoader()->LoadFile([&](char* dest, size_t sourceOffset, size_t destSize)
+    auto model = GetModel(modelID);
+
+    WriteLock lock(model->mutex);
+    model->GetLoader()->LoadFile([&](char* dest, size_t sourceOffset, size_t destSize)
                     {
                         emscripten::val retVal = callback((uint32_t)dest,sourceOffset, destSize);
                         uint32_t len = retVal.as<uint32_t>();
@@ -105,9 +405,74 @@ int OpenModel(webifc::utility::LoaderSettings settings, emscripten::val callback
     return modelID;
 }
 
+/**
+ * Opens several models from buffers already staged in the wasm heap.
+ * In the multi-threaded build the files are tokenized and indexed in parallel, one model per worker.
+ * @param dataPtrs heap addresses of _malloc'ed file contents, each model takes ownership of its buffer, so the caller must not free them.
+ * A buffer is freed as soon as its model is loaded if the whole tape fit in MEMORY_LIMIT, otherwise the loader reads evicted chunks
+ * back from it and it is freed when the model is closed
+ * @param dataSizes size in bytes of each buffer
+ */
+std::vector<uint32_t> OpenModels(webifc::utility::LoaderSettings settings, emscripten::val dataPtrs, emscripten::val dataSizes)
+{
+    uint32_t count = dataPtrs["length"].as<uint32_t>();
+
+    std::vector<uint32_t> modelIDs;
+    std::vector<const char *> sources;
+    std::vector<size_t> sizes;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        sources.push_back(reinterpret_cast<const char *>(dataPtrs[std::to_string(i)].as<uint32_t>()));
+        sizes.push_back(dataSizes[std::to_string(i)].as<uint32_t>());
+        modelIDs.push_back(CreateModel(settings));
+        GetModel(modelIDs.back())->AdoptSource(const_cast<char *>(sources.back()));
+    }
+
+    auto loadModel = [&](uint32_t i)
+    {
+        const char * source = sources[i];
+        size_t size = sizes[i];
+        auto model = GetModel(modelIDs[i]);
+
+        WriteLock lock(model->mutex);
+        model->GetLoader()->LoadFile([source, size](char* dest, size_t sourceOffset, size_t destSize)
+                        {
+                            if (sourceOffset >= size) return (uint32_t)0;
+                            size_t len = std::min(size - sourceOffset, destSize);
+                            std::memcpy(dest, source + sourceOffset, len);
+                            return (uint32_t)len;
+                        });
+        model->ReleaseSourceIfLoaded();
+    };
+
+#ifdef __EMSCRIPTEN_PTHREADS__
+    std::atomic<uint32_t> next(0);
+    uint32_t numWorkers = std::min<uint32_t>(count, std::max<uint32_t>(1, std::thread::hardware_concurrency()));
+    std::vector<std::thread> workers;
+    for (uint32_t w = 0; w < numWorkers; w++)
+    {
+        workers.emplace_back([&]()
+        {
+            for (uint32_t i = next++; i < count; i = next++) loadModel(i);
+        });
+    }
+    for (auto &worker : workers) worker.join();
+#else
+    for (uint32_t i = 0; i < count; i++) loadModel(i);
+#endif
+
+    return modelIDs;
+}
+
 void SaveModel(uint32_t modelID, emscripten::val callback)
 {
-    models[modelID].GetLoader()->SaveFile([&](char* src, size_t srcSize)
+    auto model = GetModel(modelID);
+    if (!model) return;
+    WriteLock lock(model->mutex);
+    auto loader = model->GetLoader();
+    if (!loader) return;
+
+    loader->SaveFile([&](char* src, size_t srcSize)
         {
             emscripten::val retVal = callback((uint32_t)src, srcSize);
         }
@@ -116,17 +481,45 @@ void SaveModel(uint32_t modelID, emscripten::val callback)
 
 int GetModelSize(uint32_t modelID)
 {
-    return models[modelID].GetLoader()->GetTotalSize();
+    auto model = GetModel(modelID);
+    if (!model) return 0;
+    ReadLock lock(model->mutex);
+    auto loader = model->GetLoader();
+    if (!loader) return 0;
+
+    return loader->GetTotalSize();
 }
 
 void CloseModel(uint32_t modelID)
 {
-    models[modelID].Close();
+    auto model = GetModel(modelID);
+    if (!model) return;
+
+    {
+        WriteLock lock(model->mutex);
+        if (!model->IsOpen()) return;
+        if (model->IsMeshingInParallel())
+        {
+            webifc::utility::log::error("CloseModel: the model is streaming meshes, close it once the stream has returned");
+            return;
+        }
+        model->Close();
+    }
+
+    WriteLock lock(modelsMutex);
+    freeModelIDs.push_back(modelID);
 }
 
 webifc::geometry::IfcFlatMesh GetFlatMesh(uint32_t modelID, uint32_t expressID)
 {
-    auto geomLoader = models[modelID].GetGeometryLoader();
+    auto model = GetModel(modelID);
+    if (!model)
+    {
+        return {};
+    }
+
+    WriteLock lock(model->mutex);
+    auto geomLoader = model->GetGeometryLoader();
 
     if (!geomLoader)
     {
@@ -138,63 +531,206 @@ webifc::geometry::IfcFlatMesh GetFlatMesh(uint32_t modelID, uint32_t expressID)
     for (auto& geom : mesh.geometries)
     {
         auto& flatGeom = geomLoader->GetGeometry(geom.geometryExpressID);
-        flatGeom.GetVertexData();
+        model->PrepareVertexData(flatGeom);
     }
 
     return mesh;
 }
 
-void StreamMeshes(uint32_t modelID, std::vector<uint32_t> expressIds, emscripten::val callback) {
-    auto loader = models[modelID].GetLoader();
-    auto geomLoader = models[modelID].GetGeometryLoader();
-
+/**
+ * Meshes the given elements and passes each mesh with its index in expressIds to deliver, on the calling thread which holds the model lock.
+ * The geometries of a delivered mesh are in the model's geometry processor until deliver clears them.
+ * In the multi-threaded build the elements are meshed by the model's GEOMETRY_THREADS workers, each with its own reader on the tape,
+ * geometry processor and error buffer, the errors and boolean timings are merged into the model's when all elements are done.
+ * Workers claim elements from a shared counter and stay at most a few elements ahead of delivery, which happens in element
+ * order unless STREAM_IN_ORDER is off. While they run, CloseModel, WriteLine and WriteHeaderLine refuse to change the model,
+ * and a stream started from deliver meshes on the calling thread.
+ */
+void GenerateMeshes(ModelInfo &model, const std::vector<uint32_t> &expressIds, const std::function<void(webifc::geometry::IfcFlatMesh &, uint32_t)> &deliver, bool reverseMirrored = true)
+{
+    auto loader = model.GetLoader();
+    auto geomLoader = model.GetGeometryLoader();
     if (!loader || !geomLoader)
     {
         return;
     }
 
-    int index = 0;
+    auto &settings = model.GetSettings();
+    uint32_t count = expressIds.size();
+    uint32_t numWorkers = std::min<uint32_t>(GetGeometryThreads(settings), count);
+
+    // the coordination matrix comes from the first mesh, so it is found here before workers copy it
+    uint32_t start = 0;
+    bool parallel = numWorkers > 1 && !model.IsMeshingInParallel() && loader->CanCreateReaders();
+    while (start < count && (!parallel || (settings.COORDINATE_TO_ORIGIN && !geomLoader->IsCoordinated())))
+    {
+        webifc::geometry::IfcFlatMesh mesh = geomLoader->GetFlatMesh(expressIds[start], reverseMirrored);
+        deliver(mesh, start++);
+        loader = model.GetLoader();
+        geomLoader = model.GetGeometryLoader();
+        if (!loader || !geomLoader)
+        {
+            return;
+        }
+    }
+    if (start == count)
+    {
+        return;
+    }
+
+    // fetched after the sequential prefix, whose callbacks may have written lines and dropped them
+    auto &geometryWorkers = model.GetGeometryWorkers();
+    numWorkers = std::min<uint32_t>(numWorkers, geometryWorkers.size());
+
+    struct MeshResult
+    {
+        webifc::geometry::IfcFlatMesh mesh;
+        std::unordered_map<uint32_t, webifc::geometry::IfcGeometry> geometries;
+    };
+
+    std::mutex resultsMutex;
+    std::condition_variable resultReady;
+    std::condition_variable deliveredOne;
+    std::map<uint32_t, MeshResult> results;
+    uint32_t next = start;
+    uint32_t delivered = start;
+    const uint32_t window = numWorkers * 4;
+    const glm::dmat4 transformation = geomLoader->GetTransformation();
+    const bool coordinated = geomLoader->IsCoordinated();
+    const glm::dmat4 coordinationMatrix = geomLoader->GetCoordinationMatrix();
+
+    std::vector<webifc::geometry::BoolTiming> boolTimings;
+    std::vector<std::thread> workers;
+    model.SetMeshingInParallel(true);
+    for (uint32_t w = 0; w < numWorkers; w++)
+    {
+        workers.emplace_back([&, &processor = *geometryWorkers[w]->processor]()
+        {
+            processor.SetTransformation(transformation);
+            if (coordinated) processor.SetCoordinationMatrix(coordinationMatrix);
+
+            while (true)
+            {
+                uint32_t index;
+                {
+                    std::unique_lock<std::mutex> guard(resultsMutex);
+                    deliveredOne.wait(guard, [&]() { return next - delivered < window; });
+                    if (next >= count) break;
+                    index = next++;
+                }
+
+                MeshResult result;
+                result.mesh = processor.GetFlatMesh(expressIds[index], reverseMirrored);
+                for (auto &geom : result.mesh.geometries)
+                {
+                    if (result.geometries.count(geom.geometryExpressID) == 0) result.geometries.emplace(geom.geometryExpressID, std::move(processor.GetGeometry(geom.geometryExpressID)));
+                }
+                processor.Clear();
+
+                std::lock_guard<std::mutex> guard(resultsMutex);
+                results.emplace(index, std::move(result));
+                resultReady.notify_one();
+            }
+
+            auto timings = processor.TakeSlowestBools();
+            std::lock_guard<std::mutex> guard(resultsMutex);
+            boolTimings.insert(boolTimings.end(), timings.begin(), timings.end());
+        });
+    }
+
+    for (uint32_t i = start; i < count; i++)
+    {
+        uint32_t index;
+        MeshResult result;
+        {
+            std::unique_lock<std::mutex> guard(resultsMutex);
+            resultReady.wait(guard, [&]() { return settings.STREAM_IN_ORDER ? results.count(delivered) > 0 : !results.empty(); });
+            auto it = settings.STREAM_IN_ORDER ? results.find(delivered) : results.begin();
+            index = it->first;
+            result = std::move(it->second);
+            results.erase(it);
+            delivered++;
+        }
+        deliveredOne.notify_all();
+
+        // CloseModel is refused while the workers run, so the processor is still there
+        geomLoader = model.GetGeometryLoader();
+        if (!geomLoader) continue;
+        for (auto &[id, geometry] : result.geometries) geomLoader->SetGeometry(id, std::move(geometry));
+        deliver(result.mesh, index);
+    }
+
+    for (auto &worker : workers) worker.join();
+    model.SetMeshingInParallel(false);
+    for (uint32_t w = 0; w < numWorkers; w++)
+    {
+        model.GetErrorHanlder()->MergeErrors(geometryWorkers[w]->errorHandler);
+        geometryWorkers[w]->errorHandler.ClearErrors();
+    }
+    geomLoader = model.GetGeometryLoader();
+    if (geomLoader) geomLoader->AddBoolTimings(boolTimings);
+}
+
+void StreamMeshes(uint32_t modelID, const std::vector<uint32_t> &expressIds, emscripten::val callback) {
+    auto model = GetModel(modelID);
+    if (!model)
+    {
+        return;
+    }
+
     int total = expressIds.size();
 
-    for (const auto& id : expressIds)
+    WriteLock lock(model->mutex);
+    GenerateMeshes(*model, expressIds, [&](webifc::geometry::IfcFlatMesh &mesh, uint32_t index)
     {
-        // read the mesh from IFC
-        webifc::geometry::IfcFlatMesh mesh = geomLoader->GetFlatMesh(id);
+        auto geomLoader = model->GetGeometryLoader();
 
         // prepare the geometry data
         for (auto& geom : mesh.geometries)
         {
             auto& flatGeom = geomLoader->GetGeometry(geom.geometryExpressID);
-            flatGeom.GetVertexData();
+            model->PrepareVertexData(flatGeom);
         }   
 
         if (!mesh.geometries.empty())
         {
             // transfer control to client, geometry data is alive for the time of the callback
+            // the lock is released because the client usually calls back into the model (GetGeometry)
+            lock.unlock();
             callback(mesh, index, total);
+            lock.lock();
+            geomLoader = model->GetGeometryLoader();
         }
 
         // clear geometry, freeing memory, client is expected to have consumed the data
-        geomLoader->Clear();
-
-        index++;
-    }
+        if (geomLoader) geomLoader->Clear();
+    });
 }
 
 void StreamAllMeshesWithTypes(uint32_t modelID, const std::vector<uint32_t>& types, emscripten::val callback)
 {
-    auto loader = models[modelID].GetLoader();
-
-    if (!loader)
+    auto model = GetModel(modelID);
+    if (!model)
     {
         return;
     }
 
-    for (auto& type : types)
+    // one batch over all types keeps the workers busy across type boundaries
+    std::vector<uint32_t> elements;
     {
-        auto elements = loader->GetExpressIDsWithType(type);
-        StreamMeshes(modelID, elements, callback);
+        ReadLock lock(model->mutex);
+        auto loader = model->GetLoader();
+        if (!loader)
+        {
+            return;
+        }
+        for (auto& type : types)
+        {
+            auto typeElements = loader->GetExpressIDsWithType(type);
+            elements.insert(elements.end(), typeElements.begin(), typeElements.end());
+        }
     }
+    StreamMeshes(modelID, elements, callback);
 }
 
 void StreamAllMeshesWithTypesVal(uint32_t modelID, emscripten::val typesVal, emscripten::val callback)
@@ -215,15 +751,8 @@ void StreamAllMeshesWithTypesVal(uint32_t modelID, emscripten::val typesVal, ems
     StreamAllMeshesWithTypes(modelID, types, callback);
 }
 
-void StreamAllMeshes(uint32_t modelID, emscripten::val callback) {
-    auto loader = models[modelID].GetLoader();
-    auto geomLoader = models[modelID].GetGeometryLoader();
-
-    if (!loader || !geomLoader)
-    {
-        return;
-    }
-
+std::vector<uint32_t> GetStreamedElementTypes()
+{
     std::vector<uint32_t> types;
 
     for (auto& type : schemaManager.GetIfcElementList())
@@ -236,60 +765,291 @@ void StreamAllMeshes(uint32_t modelID, emscripten::val callback) {
         types.push_back(type);
     }
 
-    StreamAllMeshesWithTypes(modelID, types, callback);
+    return types;
 }
 
-std::vector<webifc::geometry::IfcFlatMesh> LoadAllGeometry(uint32_t modelID)
+void StreamAllMeshes(uint32_t modelID, emscripten::val callback) {
+    StreamAllMeshesWithTypes(modelID, GetStreamedElementTypes(), callback);
+}
+
+/**
+ * Opens a model and streams its meshes while the file is still being tokenized.
+ * After every tape chunk the new lines are indexed and each element whose referenced lines are all indexed is meshed,
+ * so lowering TAPE_SIZE gives finer grained progress. Relationships pointing at an element (openings, materials) may
+ * come later in the file, elements that gained one by the end of the file are streamed again.
+ * The callbacks must not close the model or write lines to it.
+ * @param progressCallback called with (model ID, bytes read, lines indexed) after every chunk, before its meshes, returning false cancels the load
+ * @returns the model ID, or -1 if the load was cancelled, in which case the model is closed
+ */
+int OpenModelAndStreamMeshes(webifc::utility::LoaderSettings settings, emscripten::val dataCallback, emscripten::val meshCallback, emscripten::val progressCallback)
 {
-    auto loader = models[modelID].GetLoader();
-    auto geomLoader = models[modelID].GetGeometryLoader();
+    auto modelID = CreateModel(settings);
+    auto model = GetModel(modelID);
+
+    auto types = GetStreamedElementTypes();
+    std::unordered_set<uint32_t> elementTypes(types.begin(), types.end());
+    std::vector<uint32_t> pending;
+    std::unordered_set<uint32_t> resolved;
+    // relationships known for each streamed element when it was meshed, styles hang off its representation items
+    struct StreamedElement
+    {
+        size_t voids;
+        size_t materials;
+        size_t styles;
+        std::vector<uint32_t> items;
+    };
+    std::unordered_map<uint32_t, StreamedElement> streamed;
+    size_t scannedLines = 0;
+    size_t linesAtReset = 0;
+    int index = 0;
+    bool cancelled = false;
 
-    if (!loader || !geomLoader)
+    WriteLock lock(model->mutex);
+    auto loader = model->GetLoader();
+
+    auto countRelationships = [](const auto &relationships, uint32_t expressID) -> size_t
     {
-        return {};
-    }
+        auto it = relationships.find(expressID);
+        return it == relationships.end() ? 0 : it->second.size();
+    };
 
-    std::vector<webifc::geometry::IfcFlatMesh> meshes;
+    auto countStyles = [&](const auto &styledItems, uint32_t expressID, const std::vector<uint32_t> &items) -> size_t
+    {
+        size_t styles = countRelationships(styledItems, expressID);
+        for (auto item : items) styles += countRelationships(styledItems, item);
+        return styles;
+    };
 
-    for (auto type : schemaManager.GetIfcElementList())
+    auto streamElement = [&](uint32_t expressID)
     {
-        auto elements = loader->GetExpressIDsWithType(type);
+        auto geomLoader = model->GetGeometryLoader();
+        webifc::geometry::IfcFlatMesh mesh = geomLoader->GetFlatMesh(expressID);
+        for (auto& geom : mesh.geometries)
+        {
+            auto& flatGeom = geomLoader->GetGeometry(geom.geometryExpressID);
+            model->PrepareVertexData(flatGeom);
+        }
+        auto &relationships = geomLoader->GetLoader();
+        std::vector<uint32_t> items;
+        for (auto &geom : mesh.geometries) items.push_back(geom.geometryExpressID);
+        size_t styles = countStyles(relationships.GetStyledItems(), expressID, items);
+        streamed[expressID] = { countRelationships(relationships.GetRelVoids(), expressID), countRelationships(relationships.GetRelMaterials(), expressID), styles, std::move(items) };
 
-        if (type == webifc::schema::IFCOPENINGELEMENT || type == webifc::schema::IFCSPACE || type == webifc::schema::IFCOPENINGSTANDARDCASE)
+        if (!mesh.geometries.empty())
         {
-            continue;
+            lock.unlock();
+            meshCallback(mesh, index, (int)loader->GetNumLines());
+            lock.lock();
+            geomLoader = model->GetGeometryLoader();
         }
+        geomLoader->Clear();
+        index++;
+    };
 
-        for (uint32_t i = 0; i < elements.size(); i++)
+    loader->LoadFile([&](char* dest, size_t sourceOffset, size_t destSize)
+        {
+            emscripten::val retVal = dataCallback((uint32_t)dest, sourceOffset, destSize);
+            return retVal.as<uint32_t>();
+        },
+        [&](size_t bytesRead, size_t numLines)
         {
-            webifc::geometry::IfcFlatMesh mesh = geomLoader->GetFlatMesh(elements[i]);
-            for (auto& geom : mesh.geometries)
+            // progress goes first so the client learns the model ID before any mesh of this chunk arrives
+            lock.unlock();
+            emscripten::val retVal = progressCallback(modelID, (uint32_t)bytesRead, (uint32_t)numLines);
+            lock.lock();
+            cancelled = !retVal.isUndefined() && !retVal.as<bool>();
+            if (cancelled) return false;
+            model->InvalidateInverseIndexes();
+
+            for (; scannedLines < numLines; scannedLines++)
+            {
+                auto &line = loader->GetLine(scannedLines);
+                if (elementTypes.count(line.ifcType)) pending.push_back(line.expressID);
+            }
+
+            std::vector<uint32_t> waiting;
+            std::vector<uint32_t> ready;
+            for (auto expressID : pending)
             {
-                auto& flatGeom = geomLoader->GetGeometry(geom.geometryExpressID);
-                flatGeom.GetVertexData();
-            }   
-            meshes.push_back(std::move(mesh));
+                if (loader->IsReferenceClosureLoaded(expressID, resolved)) ready.push_back(expressID);
+                else waiting.push_back(expressID);
+            }
+            pending.swap(waiting);
+
+            if (!ready.empty())
+            {
+                // the processor reads the relationships once on construction, rebuilding it each time the index doubles keeps the total cost linear
+                if (numLines >= 2 * linesAtReset)
+                {
+                    model->ResetGeometryLoader();
+                    linesAtReset = numLines;
+                }
+                for (auto expressID : ready) streamElement(expressID);
+            }
+            return true;
+        });
+
+    if (cancelled)
+    {
+        lock.unlock();
+        CloseModel(modelID);
+        return -1;
+    }
+
+    model->ResetGeometryLoader();
+    for (auto expressID : pending) streamElement(expressID);
+
+    std::vector<uint32_t> outdated;
+    auto &relationships = model->GetGeometryLoader()->GetLoader();
+    for (auto &[expressID, element] : streamed)
+    {
+        if (element.voids != countRelationships(relationships.GetRelVoids(), expressID) || element.materials != countRelationships(relationships.GetRelMaterials(), expressID)
+            || element.styles != countStyles(relationships.GetStyledItems(), expressID, element.items))
+        {
+            outdated.push_back(expressID);
         }
     }
+    std::sort(outdated.begin(), outdated.end());
+    for (auto expressID : outdated) streamElement(expressID);
+
+    return modelID;
+}
+
+std::vector<webifc::geometry::IfcFlatMesh> LoadAllGeometry(uint32_t modelID)
+{
+    auto model = GetModel(modelID);
+    if (!model)
+    {
+        return {};
+    }
+
+    WriteLock lock(model->mutex);
+    auto loader = model->GetLoader();
+    auto geomLoader = model->GetGeometryLoader();
+
+    if (!loader || !geomLoader)
+    {
+        return {};
+    }
+
+    std::vector<uint32_t> elements;
+    for (auto type : GetStreamedElementTypes())
+    {
+        auto typeElements = loader->GetExpressIDsWithType(type);
+        elements.insert(elements.end(), typeElements.begin(), typeElements.end());
+    }
+
+    std::vector<webifc::geometry::IfcFlatMesh> meshes(elements.size());
+    GenerateMeshes(*model, elements, [&](webifc::geometry::IfcFlatMesh &mesh, uint32_t index)
+    {
+        for (auto& geom : mesh.geometries)
+        {
+            auto& flatGeom = model->GetGeometryLoader()->GetGeometry(geom.geometryExpressID);
+            model->PrepareVertexData(flatGeom);
+        }   
+        meshes[index] = std::move(mesh);
+    });
 
     return meshes;
 }
 
 webifc::geometry::IfcGeometry GetGeometry(uint32_t modelID, uint32_t expressID)
 {
-    auto geomLoader = models[modelID].GetGeometryLoader();
-    if (!geomLoader)
+    auto model = GetModel(modelID);
+    if (!model)
+    {
+        return {};
+    }
+
+    WriteLock lock(model->mutex);
+    auto geomLoader = model->GetGeometryLoader();
+    if (!geomLoader)
+    {
+        return {};
+    }
+
+    return geomLoader->GetGeometry(expressID);
+}
+
+emscripten::val PinnedGeometryToVal(uint32_t handle, const ModelInfo::PinnedGeometry &pinned)
+{
+    auto retVal = emscripten::val::object();
+    retVal.set("handle", handle);
+    retVal.set("vertexFormat", pinned.vertexFormat);
+    retVal.set("dequantizationMatrix", pinned.dequantizationMatrix);
+    retVal.set("vertexData", (uint32_t)(size_t)pinned.vertexData.data());
+    retVal.set("vertexDataSize", (uint32_t)pinned.vertexData.size());
+    retVal.set("indexData", (uint32_t)(size_t)pinned.indexData.data());
+    retVal.set("indexDataSize", (uint32_t)pinned.indexData.size());
+    return retVal;
+}
+
+/**
+ * Keeps the vertex and index buffers of a geometry alive in the heap until ReleaseGeometries is called,
+ * so the client can read them through views instead of copying them out before the next mesh is streamed.
+ * Pinning a geometry placed twice in the same mesh returns the same handle, it is released once.
+ * @returns object with the pin handle and the heap addresses and sizes of both buffers
+ */
+emscripten::val PinGeometry(uint32_t modelID, uint32_t expressID)
+{
+    auto model = GetModel(modelID);
+    if (!model)
+    {
+        return emscripten::val::undefined();
+    }
+
+    WriteLock lock(model->mutex);
+    auto geomLoader = model->GetGeometryLoader();
+    if (!geomLoader)
+    {
+        return emscripten::val::undefined();
+    }
+
+    uint32_t handle = model->PinGeometry(expressID, geomLoader->GetGeometry(expressID));
+    return PinnedGeometryToVal(handle, *model->GetPinnedGeometry(handle));
+}
+
+emscripten::val GetPinnedGeometry(uint32_t modelID, uint32_t handle)
+{
+    auto model = GetModel(modelID);
+    if (!model)
+    {
+        return emscripten::val::undefined();
+    }
+
+    WriteLock lock(model->mutex);
+    auto pinned = model->GetPinnedGeometry(handle);
+    if (!pinned)
+    {
+        return emscripten::val::undefined();
+    }
+    return PinnedGeometryToVal(handle, *pinned);
+}
+
+void ReleaseGeometries(uint32_t modelID, emscripten::val handles)
+{
+    auto model = GetModel(modelID);
+    if (!model)
     {
-        return {};
+        return;
     }
 
-    return geomLoader->GetGeometry(expressID);
+    WriteLock lock(model->mutex);
+    uint32_t size = handles["length"].as<uint32_t>();
+    for (uint32_t i = 0; i < size; i++) model->ReleaseGeometry(handles[std::to_string(i)].as<uint32_t>());
 }
 
 std::vector<webifc::geometry::IfcAlignment> GetAllAlignments(uint32_t modelID)
 {
-    auto loader = models[modelID].GetLoader();
-    auto geomLoader = models[modelID].GetGeometryLoader();
+    auto model = GetModel(modelID);
+    if (!model)
+    {
+        return {};
+    }
+
+    WriteLock lock(model->mutex);
+    auto loader = model->GetLoader();
+    auto geomLoader = model->GetGeometryLoader();
 
     if (!loader || !geomLoader)
     {
@@ -314,7 +1074,14 @@ std::vector<webifc::geometry::IfcAlignment> GetAllAlignments(uint32_t modelID)
 
 std::vector<webifc::utility::LoaderError> GetAndClearErrors(uint32_t modelID)
 {
-    auto errorHandler = models[modelID].GetErrorHanlder();
+    auto model = GetModel(modelID);
+    if (!model)
+    {
+        return {};
+    }
+
+    WriteLock lock(model->mutex);
+    auto errorHandler = model->GetErrorHanlder();
 
     if (!errorHandler)
     {
@@ -328,7 +1095,14 @@ std::vector<webifc::utility::LoaderError> GetAndClearErrors(uint32_t modelID)
 
 void SetGeometryTransformation(uint32_t modelID, std::array<double, 16> m)
 {
-    auto geomLoader = models[modelID].GetGeometryLoader();
+    auto model = GetModel(modelID);
+    if (!model)
+    {
+        return;
+    }
+
+    WriteLock lock(model->mutex);
+    auto geomLoader = model->GetGeometryLoader();
     if (!geomLoader)
     {
         return;
@@ -365,7 +1139,14 @@ std::array<double, 16> FlattenTransformation(const glm::dmat4 &transformation)
 
 std::array<double, 16> GetCoordinationMatrix(uint32_t modelID)
 {
-    auto geomLoader = models[modelID].GetGeometryLoader();
+    auto model = GetModel(modelID);
+    if (!model)
+    {
+        return {};
+    }
+
+    WriteLock lock(model->mutex);
+    auto geomLoader = model->GetGeometryLoader();
     if (!geomLoader)
     {
         return {};
@@ -374,14 +1155,8 @@ std::array<double, 16> GetCoordinationMatrix(uint32_t modelID)
     return FlattenTransformation(geomLoader->GetCoordinationMatrix());
 }
 
-std::vector<uint32_t> GetLineIDsWithType(uint32_t modelID, emscripten::val types)
+std::vector<uint32_t> GetLineIDsWithType(webifc::parsing::IfcLoader * loader, emscripten::val types)
 {
-    auto loader = models[modelID].GetLoader();
-    if (!loader)
-    {
-        return {};
-    }
-
     std::vector<uint32_t> expressIDs;
 
     uint32_t size = types["length"].as<uint32_t>();
@@ -397,15 +1172,40 @@ std::vector<uint32_t> GetLineIDsWithType(uint32_t modelID, emscripten::val types
     return expressIDs;
 }
 
+std::vector<uint32_t> GetLineIDsWithType(uint32_t modelID, emscripten::val types)
+{
+    auto model = GetModel(modelID);
+    if (!model)
+    {
+        return {};
+    }
+
+    ReadLock lock(model->mutex);
+    auto loader = model->GetLoader();
+    if (!loader)
+    {
+        return {};
+    }
+
+    return GetLineIDsWithType(loader, types);
+}
+
 std::vector<uint32_t> GetInversePropertyForItem(uint32_t modelID, uint32_t expressID, emscripten::val targetTypes, uint32_t position, bool set)
 {
-    auto loader = models[modelID].GetLoader();
+    auto model = GetModel(modelID);
+    if (!model)
+    {
+        return {};
+    }
+
+    WriteLock lock(model->mutex);
+    auto loader = model->GetLoader();
     if (!loader)
     {
         return {};
     }
     std::vector<uint32_t> inverseIDs;
-    auto expressIDs = GetLineIDsWithType(modelID,targetTypes);
+    auto expressIDs = GetLineIDsWithType(loader,targetTypes);
     for (auto foundExpressID : expressIDs)
     {
       auto lineID = loader->ExpressIDToLineID(foundExpressID); 
@@ -446,7 +1246,14 @@ std::vector<uint32_t> GetInversePropertyForItem(uint32_t modelID, uint32_t expre
 
 bool ValidateExpressID(uint32_t modelID, uint32_t expressId)
 {
-    auto loader = models[modelID].GetLoader();
+    auto model = GetModel(modelID);
+    if (!model)
+    {
+        return {};
+    }
+
+    ReadLock lock(model->mutex);
+    auto loader = model->GetLoader();
     if (!loader)
     {
         return {};
@@ -457,7 +1264,14 @@ bool ValidateExpressID(uint32_t modelID, uint32_t expressId)
 
 uint32_t GetNextExpressID(uint32_t modelID, uint32_t expressId)
 {
-    auto loader = models[modelID].GetLoader();
+    auto model = GetModel(modelID);
+    if (!model)
+    {
+        return {};
+    }
+
+    ReadLock lock(model->mutex);
+    auto loader = model->GetLoader();
     if(!loader)
     {
         return {};
@@ -483,7 +1297,14 @@ uint32_t GetNextExpressID(uint32_t modelID, uint32_t expressId)
 
 std::vector<uint32_t> GetAllLines(uint32_t modelID)
 {
-    auto loader = models[modelID].GetLoader();
+    auto model = GetModel(modelID);
+    if (!model)
+    {
+        return {};
+    }
+
+    ReadLock lock(model->mutex);
+    auto loader = model->GetLoader();
     if (!loader)
     {
         return {};
@@ -498,10 +1319,9 @@ std::vector<uint32_t> GetAllLines(uint32_t modelID)
     return expressIDs;
 }
 
-bool WriteValue(uint32_t modelID, webifc::parsing::IfcTokenType t, emscripten::val value)
+bool WriteValue(webifc::parsing::IfcLoader * loader, webifc::parsing::IfcTokenType t, emscripten::val value)
 {
     bool responseCode = true;
-    auto loader = models[modelID].GetLoader();
     switch (t)
     {
     case webifc::parsing::IfcTokenType::STRING:
@@ -529,6 +1349,13 @@ bool WriteValue(uint32_t modelID, webifc::parsing::IfcTokenType t, emscripten::v
 
         break;
     }
+    case webifc::parsing::IfcTokenType::INTEGER:
+    {
+        int32_t val = value.as<int32_t>();
+        loader->Push<int32_t>(val);
+
+        break;
+    }
     default:
         // use undefined to signal val parse issue
         loader->Push<uint8_t>('?');
@@ -537,10 +1364,9 @@ bool WriteValue(uint32_t modelID, webifc::parsing::IfcTokenType t, emscripten::v
     return responseCode;
 }
 
-bool WriteSet(uint32_t modelID, emscripten::val& val)
+bool WriteSet(webifc::parsing::IfcLoader * loader, emscripten::val& val)
 {
     bool responseCode = true;
-    auto loader = models[modelID].GetLoader();
     loader->Push<uint8_t>(webifc::parsing::IfcTokenType::SET_BEGIN);
 
     uint32_t size = val["length"].as<uint32_t>();
@@ -549,7 +1375,7 @@ bool WriteSet(uint32_t modelID, emscripten::val& val)
         emscripten::val child = val[std::to_string(i)];
         if (child.isNull()) loader->Push<uint8_t>(webifc::parsing::IfcTokenType::EMPTY);
         else if (child.isUndefined()) continue;
-        else if (child.isArray()) WriteSet(modelID,child);
+        else if (child.isArray()) WriteSet(loader,child);
         else if (child["type"].isNumber())
         {
             webifc::parsing::IfcTokenType type = static_cast<webifc::parsing::IfcTokenType>(child["type"].as<uint32_t>());
@@ -584,7 +1410,7 @@ bool WriteSet(uint32_t modelID, emscripten::val& val)
                     loader->Push<uint8_t>(webifc::parsing::IfcTokenType::SET_BEGIN);
 
                     loader->Push<uint8_t>(valueType);
-                    WriteValue(modelID,valueType, value);
+                    WriteValue(loader,valueType, value);
 
                     loader->Push<uint8_t>(webifc::parsing::IfcTokenType::SET_END);
 
@@ -594,8 +1420,9 @@ bool WriteSet(uint32_t modelID, emscripten::val& val)
                 case webifc::parsing::IfcTokenType::ENUM:
                 case webifc::parsing::IfcTokenType::REF:
                 case webifc::parsing::IfcTokenType::REAL:
+                case webifc::parsing::IfcTokenType::INTEGER:
                 {
-                    WriteValue(modelID,type, child["value"]);
+                    WriteValue(loader,type, child["value"]);
                     break;
                 }
                 default:
@@ -631,17 +1458,29 @@ bool IsIfcElement(uint32_t type)
 
 bool WriteHeaderLine(uint32_t modelID,uint32_t type, emscripten::val parameters)
 {
-    auto loader = models[modelID].GetLoader();
+    auto model = GetModel(modelID);
+    if (!model)
+    {
+        return false;
+    }
+
+    WriteLock lock(model->mutex);
+    auto loader = model->GetLoader();
     if (!loader)
     {
         return false;
     }
+    if (model->IsMeshingInParallel())
+    {
+        webifc::utility::log::error("WriteHeaderLine: the model is streaming meshes, write once the stream has returned");
+        return false;
+    }
     uint32_t start = loader->GetTotalSize();
     std::string ifcName = schemaManager.IfcTypeCodeToType(type);
     loader->Push<uint8_t>(webifc::parsing::IfcTokenType::LABEL);
     loader->Push<uint16_t>((uint16_t)ifcName.size());
     loader->Push((void*)ifcName.c_str(), ifcName.size());
-    bool responseCode = WriteSet(modelID,parameters);
+    bool responseCode = WriteSet(loader,parameters);
     loader->Push<uint8_t>(webifc::parsing::IfcTokenType::LINE_END);
     uint32_t end = loader->GetTotalSize();
     loader->AddHeaderLineTape(type, start, end);
@@ -650,11 +1489,24 @@ bool WriteHeaderLine(uint32_t modelID,uint32_t type, emscripten::val parameters)
 
 bool WriteLine(uint32_t modelID, uint32_t expressID, uint32_t type, emscripten::val parameters)
 {
-    auto loader = models[modelID].GetLoader();
+    auto model = GetModel(modelID);
+    if (!model)
+    {
+        return false;
+    }
+
+    WriteLock lock(model->mutex);
+    auto loader = model->GetLoader();
     if (!loader)
     {
         return false;
     }
+    if (model->IsMeshingInParallel())
+    {
+        webifc::utility::log::error("WriteLine: the model is streaming meshes, write once the stream has returned");
+        return false;
+    }
+    model->InvalidateCaches();
     uint32_t start = loader->GetTotalSize();
 
     // line ID
@@ -666,7 +1518,7 @@ bool WriteLine(uint32_t modelID, uint32_t expressID, uint32_t type, emscripten::
     loader->Push<uint8_t>(webifc::parsing::IfcTokenType::LABEL);
     loader->Push<uint16_t>((uint16_t)ifcName.size());
     loader->Push((void*)ifcName.c_str(), ifcName.size());
-    bool responseCode = WriteSet(modelID,parameters);
+    bool responseCode = WriteSet(loader,parameters);
     // end line
     loader->Push<uint8_t>(webifc::parsing::IfcTokenType::LINE_END);
 
@@ -677,9 +1529,8 @@ bool WriteLine(uint32_t modelID, uint32_t expressID, uint32_t type, emscripten::
 }
 
 
-emscripten::val ReadValue(uint32_t modelID, webifc::parsing::IfcTokenType t)
+emscripten::val ReadValue(webifc::parsing::IfcLoader * loader, webifc::parsing::IfcTokenType t)
 {
-    auto loader = models[modelID].GetLoader();
     switch (t)
     {
     case webifc::parsing::IfcTokenType::STRING:
@@ -689,6 +1540,7 @@ emscripten::val ReadValue(uint32_t modelID, webifc::parsing::IfcTokenType t)
         return emscripten::val(s);
     }
     case webifc::parsing::IfcTokenType::REAL:
+    case webifc::parsing::IfcTokenType::INTEGER:
     {
         double d = loader->GetDoubleArgument();
         return emscripten::val(std::to_string(d));
@@ -704,9 +1556,8 @@ emscripten::val ReadValue(uint32_t modelID, webifc::parsing::IfcTokenType t)
     }
 }
 
-emscripten::val& GetArgs(uint32_t modelID, emscripten::val& arguments)
+emscripten::val& GetArgs(webifc::parsing::IfcLoader * loader, emscripten::val& arguments)
 {
-    auto loader = models[modelID].GetLoader();
     std::stack<emscripten::val> valueStack;
     std::stack<int> valuePosition;
 
@@ -787,7 +1638,7 @@ emscripten::val& GetArgs(uint32_t modelID, emscripten::val& arguments)
             // read value following label
             webifc::parsing::IfcTokenType t = loader->GetTokenType();
             loader->StepBack();
-            obj.set("value", ReadValue(modelID,t));
+            obj.set("value", ReadValue(loader,t));
 
             // read set close
             loader->GetTokenType();
@@ -799,13 +1650,15 @@ emscripten::val& GetArgs(uint32_t modelID, emscripten::val& arguments)
         case webifc::parsing::IfcTokenType::STRING:
         case webifc::parsing::IfcTokenType::ENUM:
         case webifc::parsing::IfcTokenType::REAL:
+        case webifc::parsing::IfcTokenType::INTEGER:
         case webifc::parsing::IfcTokenType::REF:
         {
             
             auto obj = emscripten::val::object(); 
             loader->StepBack();
-            obj.set("type", emscripten::val(static_cast<uint32_t>(t)));
-            obj.set("value", ReadValue(modelID,t));
+            // integers are a tape detail, javascript keeps seeing every number as REAL
+            obj.set("type", emscripten::val(static_cast<uint32_t>(t == webifc::parsing::IfcTokenType::INTEGER ? webifc::parsing::IfcTokenType::REAL : t)));
+            obj.set("value", ReadValue(loader,t));
 
             topValue.set(topPosition++, obj);
 
@@ -821,7 +1674,14 @@ emscripten::val& GetArgs(uint32_t modelID, emscripten::val& arguments)
 
 emscripten::val GetHeaderLine(uint32_t modelID, uint32_t headerType)
 {
-    auto loader = models[modelID].GetLoader();
+    auto model = GetModel(modelID);
+    if (!model)
+    {
+        return emscripten::val::undefined();
+    }
+
+    WriteLock lock(model->mutex);
+    auto loader = model->GetLoader();
     if (!loader)
     {
         return emscripten::val::undefined();
@@ -836,7 +1696,7 @@ emscripten::val GetHeaderLine(uint32_t modelID, uint32_t headerType)
 
     auto arguments = emscripten::val::array();
     std::string s(schemaManager.IfcTypeCodeToType(line.ifcType));
-    GetArgs(modelID, arguments);
+    GetArgs(loader, arguments);
     auto retVal = emscripten::val::object();
     retVal.set("ID", line.lineIndex);
     retVal.set("type", s);
@@ -846,7 +1706,14 @@ emscripten::val GetHeaderLine(uint32_t modelID, uint32_t headerType)
 
 emscripten::val GetLine(uint32_t modelID, uint32_t expressID)
 {
-    auto loader = models[modelID].GetLoader();
+    auto model = GetModel(modelID);
+    if (!model)
+    {
+        return emscripten::val::undefined();
+    }
+
+    WriteLock lock(model->mutex);
+    auto loader = model->GetLoader();
     if (!loader)
     {
         return emscripten::val::undefined();
@@ -858,7 +1725,7 @@ emscripten::val GetLine(uint32_t modelID, uint32_t expressID)
 
     auto arguments = emscripten::val::array();
 
-    GetArgs(modelID, arguments);
+    GetArgs(loader, arguments);
 
     auto retVal = emscripten::val::object();
     retVal.set(emscripten::val("ID"), line.expressID);
@@ -868,9 +1735,418 @@ emscripten::val GetLine(uint32_t modelID, uint32_t expressID)
     return retVal;
 }
 
+template <typename T> emscripten::val CopyToTypedArray(const std::vector<T> &values)
+{
+    return emscripten::val(emscripten::typed_memory_view(values.size(), values.data())).call<emscripten::val>("slice");
+}
+
+/**
+ * Flattens the property sets and element quantities of a list of elements into one column-oriented table,
+ * one row per (element, property set, property). Only single values and simple quantities carry a value,
+ * other property kinds have an EMPTY value type and can be read with GetLine through their property ID.
+ * String values and property names are stored once in the strings array and referenced by index.
+ * @returns object with the row columns elementIDs, psetIDs, propertyIDs, nameIndices, valueTypes (IfcTokenType),
+ * valueTypeCodes (the IFC type wrapping the value, or the quantity type), numberValues and stringValueIndices (-1 if none)
+ */
+emscripten::val GetPropertySetsForElements(uint32_t modelID, emscripten::val elementIDsVal)
+{
+    auto model = GetModel(modelID);
+    if (!model)
+    {
+        return emscripten::val::undefined();
+    }
+
+    WriteLock lock(model->mutex);
+    auto loader = model->GetLoader();
+    if (!loader)
+    {
+        return emscripten::val::undefined();
+    }
+
+    std::vector<uint32_t> elementIDs;
+    std::vector<uint32_t> psetIDs;
+    std::vector<uint32_t> propertyIDs;
+    std::vector<uint32_t> nameIndices;
+    std::vector<uint8_t> valueTypes;
+    std::vector<uint32_t> valueTypeCodes;
+    std::vector<double> numberValues;
+    std::vector<int32_t> stringValueIndices;
+    std::vector<std::string> strings;
+    std::unordered_map<std::string, uint32_t> stringIndices;
+
+    auto addString = [&](std::string str)
+    {
+        auto it = stringIndices.find(str);
+        if (it != stringIndices.end()) return it->second;
+        uint32_t index = strings.size();
+        stringIndices.emplace(str, index);
+        strings.push_back(std::move(str));
+        return index;
+    };
+
+    auto readName = [&](const webifc::parsing::IfcLine &line)
+    {
+        loader->MoveToArgumentOffset(line, 0);
+        if (loader->GetTokenType() != webifc::parsing::IfcTokenType::STRING) return addString("");
+        loader->StepBack();
+        return addString(loader->GetStringArgument());
+    };
+
+    // reads a value at the cursor, unwrapping typed values such as IFCLABEL('x')
+    auto addValue = [&](uint32_t typeCode)
+    {
+        auto t = loader->GetTokenType();
+        if (t == webifc::parsing::IfcTokenType::LABEL)
+        {
+            loader->StepBack();
+            typeCode = schemaManager.IfcTypeToTypeCode(loader->GetStringArgument());
+            loader->GetTokenType(); // set begin
+            t = loader->GetTokenType();
+        }
+        double number = 0;
+        int32_t stringIndex = -1;
+        switch (t)
+        {
+        case webifc::parsing::IfcTokenType::REAL:
+        case webifc::parsing::IfcTokenType::INTEGER:
+            loader->StepBack();
+            number = loader->GetDoubleArgument();
+            t = webifc::parsing::IfcTokenType::REAL;
+            break;
+        case webifc::parsing::IfcTokenType::REF:
+            loader->StepBack();
+            number = loader->GetRefArgument();
+            break;
+        case webifc::parsing::IfcTokenType::STRING:
+        case webifc::parsing::IfcTokenType::ENUM:
+            loader->StepBack();
+            stringIndex = addString(loader->GetStringArgument());
+            break;
+        default:
+            t = webifc::parsing::IfcTokenType::EMPTY;
+            break;
+        }
+        valueTypes.push_back(t);
+        valueTypeCodes.push_back(t == webifc::parsing::IfcTokenType::EMPTY ? 0 : typeCode);
+        numberValues.push_back(number);
+        stringValueIndices.push_back(stringIndex);
+    };
+
+    auto &psetIndex = model->GetInverseIndex(webifc::schema::IFCRELDEFINESBYPROPERTIES, 4, 5);
+
+    uint32_t size = elementIDsVal["length"].as<uint32_t>();
+    for (uint32_t i = 0; i < size; i++)
+    {
+        uint32_t elementID = elementIDsVal[std::to_string(i)].as<uint32_t>();
+        auto it = psetIndex.find(elementID);
+        if (it == psetIndex.end()) continue;
+
+        for (uint32_t psetID : it->second)
+        {
+            if (!loader->IsValidExpressID(psetID)) continue;
+            auto &psetLine = loader->GetLine(loader->ExpressIDToLineID(psetID));
+
+            uint32_t propertiesArgument;
+            if (psetLine.ifcType == webifc::schema::IFCPROPERTYSET) propertiesArgument = 4;
+            else if (psetLine.ifcType == webifc::schema::IFCELEMENTQUANTITY) propertiesArgument = 5;
+            else continue;
+
+            for (uint32_t propertyID : GetRefsArgument(loader, psetLine, propertiesArgument))
+            {
+                if (!loader->IsValidExpressID(propertyID)) continue;
+                auto &propertyLine = loader->GetLine(loader->ExpressIDToLineID(propertyID));
+
+                elementIDs.push_back(elementID);
+                psetIDs.push_back(psetID);
+                propertyIDs.push_back(propertyID);
+                nameIndices.push_back(readName(propertyLine));
+
+                switch (propertyLine.ifcType)
+                {
+                case webifc::schema::IFCPROPERTYSINGLEVALUE:
+                    loader->MoveToArgumentOffset(propertyLine, 2);
+                    addValue(0);
+                    break;
+                case webifc::schema::IFCQUANTITYLENGTH:
+                case webifc::schema::IFCQUANTITYAREA:
+                case webifc::schema::IFCQUANTITYVOLUME:
+                case webifc::schema::IFCQUANTITYCOUNT:
+                case webifc::schema::IFCQUANTITYWEIGHT:
+                case webifc::schema::IFCQUANTITYTIME:
+                case webifc::schema::IFCQUANTITYNUMBER:
+                    loader->MoveToArgumentOffset(propertyLine, 3);
+                    addValue(propertyLine.ifcType);
+                    break;
+                default:
+                    valueTypes.push_back(webifc::parsing::IfcTokenType::EMPTY);
+                    valueTypeCodes.push_back(0);
+                    numberValues.push_back(0);
+                    stringValueIndices.push_back(-1);
+                    break;
+                }
+            }
+        }
+    }
+
+    auto stringsVal = emscripten::val::array();
+    for (uint32_t i = 0; i < strings.size(); i++) stringsVal.set(i, strings[i]);
+
+    auto retVal = emscripten::val::object();
+    retVal.set("elementIDs", CopyToTypedArray(elementIDs));
+    retVal.set("psetIDs", CopyToTypedArray(psetIDs));
+    retVal.set("propertyIDs", CopyToTypedArray(propertyIDs));
+    retVal.set("nameIndices", CopyToTypedArray(nameIndices));
+    retVal.set("valueTypes", CopyToTypedArray(valueTypes));
+    retVal.set("valueTypeCodes", CopyToTypedArray(valueTypeCodes));
+    retVal.set("numberValues", CopyToTypedArray(numberValues));
+    retVal.set("stringValueIndices", CopyToTypedArray(stringValueIndices));
+    retVal.set("strings", stringsVal);
+    return retVal;
+}
+
+/**
+ * Builds the spatial structure of a model (IfcRelAggregates and IfcRelContainedInSpatialStructure) starting at its IfcProject.
+ * Nodes are listed depth first, a node's aggregated children come before the elements it contains.
+ * @returns object with expressIDs, types and parents, the index of each node's parent or -1 for the project
+ */
+emscripten::val GetSpatialTree(uint32_t modelID)
+{
+    auto model = GetModel(modelID);
+    if (!model)
+    {
+        return emscripten::val::undefined();
+    }
+
+    WriteLock lock(model->mutex);
+    auto loader = model->GetLoader();
+    if (!loader)
+    {
+        return emscripten::val::undefined();
+    }
+
+    std::vector<uint32_t> expressIDs;
+    std::vector<uint32_t> types;
+    std::vector<int32_t> parents;
+
+    auto projects = loader->GetExpressIDsWithType(webifc::schema::IFCPROJECT);
+    if (!projects.empty())
+    {
+        auto &aggregates = model->GetInverseIndex(webifc::schema::IFCRELAGGREGATES, 4, 5);
+        auto &containment = model->GetInverseIndex(webifc::schema::IFCRELCONTAINEDINSPATIALSTRUCTURE, 5, 4);
+
+        std::unordered_set<uint32_t> visited;
+        std::vector<std::pair<uint32_t, int32_t>> stack = { { projects[0], -1 } };
+        while (!stack.empty())
+        {
+            auto [expressID, parent] = stack.back();
+            stack.pop_back();
+            if (!loader->IsValidExpressID(expressID) || !visited.insert(expressID).second) continue;
+
+            int32_t index = expressIDs.size();
+            expressIDs.push_back(expressID);
+            types.push_back(loader->GetLine(loader->ExpressIDToLineID(expressID)).ifcType);
+            parents.push_back(parent);
+
+            // pushed in reverse so children come off the stack in file order
+            auto contained = containment.find(expressID);
+            if (contained != containment.end())
+            {
+                for (auto it = contained->second.rbegin(); it != contained->second.rend(); it++) stack.emplace_back(*it, index);
+            }
+            auto aggregated = aggregates.find(expressID);
+            if (aggregated != aggregates.end())
+            {
+                for (auto it = aggregated->second.rbegin(); it != aggregated->second.rend(); it++) stack.emplace_back(*it, index);
+            }
+        }
+    }
+
+    auto retVal = emscripten::val::object();
+    retVal.set("expressIDs", CopyToTypedArray(expressIDs));
+    retVal.set("types", CopyToTypedArray(types));
+    retVal.set("parents", CopyToTypedArray(parents));
+    return retVal;
+}
+
+/**
+ * Streams the meshes of all elements of the given types (all streamed element types if undefined) for instanced rendering. Every distinct geometry is passed
+ * to the callback once, the first time an element places it, the geometry data is alive for the time of the callback.
+ * Geometries of mapped items (IfcRepresentationMap) keep the expressID of their representation item, so all
+ * occurrences of a type share one geometry and only differ by their row in the instance table.
+ * Faces of mirrored placements are not reversed, renderers have to flip the winding when the transform's determinant is negative.
+ * With a GEOMETRY_DEDUPLICATION_TOLERANCE set, geometries with identical normalized content are streamed once as well,
+ * their rows reference the first geometry with that content and the savings are available from GetGeometryDeduplicationStats.
+ * @returns object with one row per placement: elementIDs, geometryIDs, transforms (16 doubles each, column major) and colors (4 doubles each)
+ */
+emscripten::val StreamInstancedMeshes(uint32_t modelID, emscripten::val typesVal, emscripten::val geometryCallback)
+{
+    auto model = GetModel(modelID);
+    if (!model)
+    {
+        return emscripten::val::undefined();
+    }
+
+    std::vector<uint32_t> types;
+    if (typesVal.isUndefined())
+    {
+        types = GetStreamedElementTypes();
+    }
+    else
+    {
+        uint32_t size = typesVal["length"].as<uint32_t>();
+        for (uint32_t i = 0; i < size; i++) types.push_back(typesVal[std::to_string(i)].as<uint32_t>());
+    }
+
+    std::vector<uint32_t> elementIDs;
+    std::vector<uint32_t> geometryIDs;
+    std::vector<double> transforms;
+    std::vector<double> colors;
+    // geometry expressID to the ID it is streamed under, which differs for geometries deduplicated by content
+    std::unordered_map<uint32_t, uint32_t> sharedGeometryIDs;
+    // content hash to the geometries streamed with it, a copy of each is kept to tell hash collisions from duplicates
+    std::unordered_map<uint64_t, std::vector<std::pair<uint32_t, webifc::geometry::IfcGeometry>>> geometryHashes;
+
+    WriteLock lock(model->mutex);
+    auto loader = model->GetLoader();
+    if (!loader)
+    {
+        return emscripten::val::undefined();
+    }
+    double tolerance = model->GetSettings().GEOMETRY_DEDUPLICATION_TOLERANCE;
+    model->deduplicationStats = {};
+
+    std::vector<uint32_t> elements;
+    for (auto type : types)
+    {
+        auto typeElements = loader->GetExpressIDsWithType(type);
+        elements.insert(elements.end(), typeElements.begin(), typeElements.end());
+    }
+
+    GenerateMeshes(*model, elements, [&](webifc::geometry::IfcFlatMesh &mesh, uint32_t index)
+    {
+        for (auto &geom : mesh.geometries)
+        {
+            auto geomLoader = model->GetGeometryLoader();
+            if (!geomLoader)
+            {
+                return;
+            }
+
+            auto shared = sharedGeometryIDs.find(geom.geometryExpressID);
+            uint32_t geometryID = shared == sharedGeometryIDs.end() ? geom.geometryExpressID : shared->second;
+
+            elementIDs.push_back(elements[index]);
+            geometryIDs.push_back(geometryID);
+            transforms.insert(transforms.end(), geom.flatTransformation.begin(), geom.flatTransformation.end());
+            colors.insert(colors.end(), { geom.color.r, geom.color.g, geom.color.b, geom.color.a });
+
+            if (shared != sharedGeometryIDs.end()) continue;
+
+            auto &geometry = geomLoader->GetGeometry(geom.geometryExpressID);
+            if (tolerance > 0)
+            {
+                // flattening normalized the geometry relative to its min, the offset lives in the transform
+                auto &candidates = geometryHashes[geometry.GetContentHash(tolerance)];
+                auto match = std::find_if(candidates.begin(), candidates.end(), [&](const auto &candidate) { return geometry.HasSameContent(candidate.second, tolerance); });
+                if (match != candidates.end())
+                {
+                    geometryIDs.back() = match->first;
+                    sharedGeometryIDs.emplace(geom.geometryExpressID, match->first);
+                    model->deduplicationStats.duplicateGeometries++;
+                    model->deduplicationStats.bytesSaved += geometry.numPoints * webifc::geometry::VertexFormatWords(model->GetSettings().VERTEX_FORMAT) * sizeof(float) + geometry.indexData.size() * sizeof(uint32_t);
+                    continue;
+                }
+                // only what HasSameContent compares is kept, the geometry itself is cleared after the callback
+                webifc::geometry::IfcGeometry content;
+                content.vertexData = geometry.vertexData;
+                content.indexData = geometry.indexData;
+                content.numPoints = geometry.numPoints;
+                content.numFaces = geometry.numFaces;
+                candidates.emplace_back(geom.geometryExpressID, std::move(content));
+            }
+            sharedGeometryIDs.emplace(geom.geometryExpressID, geom.geometryExpressID);
+            model->deduplicationStats.uniqueGeometries++;
+
+            model->PrepareVertexData(geometry);
+
+            // same contract as StreamMeshes, the client reads the geometry through GetGeometry during the callback
+            lock.unlock();
+            geometryCallback(geom.geometryExpressID);
+            lock.lock();
+        }
+
+        auto geomLoader = model->GetGeometryLoader();
+        if (geomLoader) geomLoader->Clear();
+    }, false);
+
+    auto retVal = emscripten::val::object();
+    retVal.set("elementIDs", CopyToTypedArray(elementIDs));
+    retVal.set("geometryIDs", CopyToTypedArray(geometryIDs));
+    retVal.set("transforms", CopyToTypedArray(transforms));
+    retVal.set("colors", CopyToTypedArray(colors));
+    return retVal;
+}
+
+/**
+ * Reports the slowest boolean subtractions of a model, slowest first, to find the elements that dominate meshing time.
+ * @returns array of objects with expressID (the element or IfcBooleanResult), milliseconds, the point counts of both operands
+ * and whether the boolean was aborted by BOOL_ABORT_THRESHOLD or BOOL_TIME_BUDGET
+ */
+emscripten::val GetSlowestBooleans(uint32_t modelID)
+{
+    auto model = GetModel(modelID);
+    if (!model)
+    {
+        return emscripten::val::undefined();
+    }
+
+    WriteLock lock(model->mutex);
+    auto geomLoader = model->GetGeometryLoader();
+    if (!geomLoader)
+    {
+        return emscripten::val::undefined();
+    }
+
+    auto retVal = emscripten::val::array();
+    for (auto &timing : geomLoader->GetSlowestBools())
+    {
+        auto entry = emscripten::val::object();
+        entry.set("expressID", timing.expressID);
+        entry.set("milliseconds", timing.milliseconds);
+        entry.set("firstPoints", timing.firstPoints);
+        entry.set("secondPoints", timing.secondPoints);
+        entry.set("aborted", timing.aborted);
+        retVal.call<void>("push", entry);
+    }
+    return retVal;
+}
+
+emscripten::val GetGeometryDeduplicationStats(uint32_t modelID)
+{
+    auto model = GetModel(modelID);
+    if (!model)
+    {
+        return emscripten::val::undefined();
+    }
+
+    ReadLock lock(model->mutex);
+    auto retVal = emscripten::val::object();
+    retVal.set("uniqueGeometries", model->deduplicationStats.uniqueGeometries);
+    retVal.set("duplicateGeometries", model->deduplicationStats.duplicateGeometries);
+    retVal.set("bytesSaved", model->deduplicationStats.bytesSaved);
+    return retVal;
+}
+
 uint32_t GetLineType(uint32_t modelID, uint32_t expressID)
 {
-    auto loader = models[modelID].GetLoader();
+    auto model = GetModel(modelID);
+    if (!model)
+    {
+        return -1;
+    }
+
+    ReadLock lock(model->mutex);
+    auto loader = model->GetLoader();
     if (!loader)
     {
         return -1;
@@ -885,22 +2161,39 @@ std::string GetVersion()
     return WEB_IFC_VERSION_NUMBER;
 }
 
+bool IsMultiThreaded()
+{
+    return MT_ENABLED;
+}
+
 uint32_t GetMaxExpressID(uint32_t modelID)
 {
-    auto loader = models[modelID].GetLoader();
+    auto model = GetModel(modelID);
+    if (!model)
+    {
+        return 0;
+    }
+
+    ReadLock lock(model->mutex);
+    auto loader = model->GetLoader();
+    if (!loader)
+    {
+        return 0;
+    }
+
     return loader->GetMaxExpressId();
 }
 
 extern "C" bool IsModelOpen(uint32_t modelID)
 {
-    if (modelID >= models.size()) return false;
-    auto loader = models[modelID].GetLoader();
-    if (!loader)
+    auto model = GetModel(modelID);
+    if (!model)
     {
         return false;
     }
 
-    return true;
+    ReadLock lock(model->mutex);
+    return model->IsOpen();
 }
 
 // TODO(pablo): the level param ought to be LogLevel, but I couldn't
@@ -924,6 +2217,7 @@ EMSCRIPTEN_BINDINGS(my_module) {
         .function("GetVertexDataSize", &webifc::geometry::IfcGeometry::GetVertexDataSize)
         .function("GetIndexData", &webifc::geometry::IfcGeometry::GetIndexData)
         .function("GetIndexDataSize", &webifc::geometry::IfcGeometry::GetIndexDataSize)
+        .function("GetDequantizationMatrix", &webifc::geometry::IfcGeometry::GetDequantizationMatrix)
         ;
 
 
@@ -940,9 +2234,23 @@ EMSCRIPTEN_BINDINGS(my_module) {
         .field("CIRCLE_SEGMENTS_LOW", &webifc::utility::LoaderSettings::CIRCLE_SEGMENTS_LOW)
         .field("CIRCLE_SEGMENTS_MEDIUM", &webifc::utility::LoaderSettings::CIRCLE_SEGMENTS_MEDIUM)
         .field("CIRCLE_SEGMENTS_HIGH", &webifc::utility::LoaderSettings::CIRCLE_SEGMENTS_HIGH)
+        .field("CURVE_MAX_DEVIATION", &webifc::utility::LoaderSettings::CURVE_MAX_DEVIATION)
+        .field("CURVE_MAX_ANGLE", &webifc::utility::LoaderSettings::CURVE_MAX_ANGLE)
+        .field("CURVE_MIN_SEGMENTS", &webifc::utility::LoaderSettings::CURVE_MIN_SEGMENTS)
+        .field("CURVE_MAX_SEGMENTS", &webifc::utility::LoaderSettings::CURVE_MAX_SEGMENTS)
         .field("BOOL_ABORT_THRESHOLD", &webifc::utility::LoaderSettings::BOOL_ABORT_THRESHOLD)
+        .field("BOOL_TIME_BUDGET", &webifc::utility::LoaderSettings::BOOL_TIME_BUDGET)
+        .field("BOOL_MERGE_OPERANDS", &webifc::utility::LoaderSettings::BOOL_MERGE_OPERANDS)
+        .field("CREASE_ANGLE", &webifc::utility::LoaderSettings::CREASE_ANGLE)
+        .field("VERTEX_FORMAT", &webifc::utility::LoaderSettings::VERTEX_FORMAT)
+        .field("KEEP_DOUBLE_VERTICES", &webifc::utility::LoaderSettings::KEEP_DOUBLE_VERTICES)
         .field("TAPE_SIZE", &webifc::utility::LoaderSettings::TAPE_SIZE)
         .field("MEMORY_LIMIT", &webifc::utility::LoaderSettings::MEMORY_LIMIT)
+        .field("GEOMETRY_CACHE_SIZE", &webifc::utility::LoaderSettings::GEOMETRY_CACHE_SIZE)
+        .field("GEOMETRY_DEDUPLICATION_TOLERANCE", &webifc::utility::LoaderSettings::GEOMETRY_DEDUPLICATION_TOLERANCE)
+        .field("GEOMETRY_THREADS", &webifc::utility::LoaderSettings::GEOMETRY_THREADS)
+        .field("STREAM_IN_ORDER", &webifc::utility::LoaderSettings::STREAM_IN_ORDER)
+        .field("BREP_PARALLEL_FACES", &webifc::utility::LoaderSettings::BREP_PARALLEL_FACES)
     ;
 
     emscripten::value_array<std::array<double, 16>>("array_double_16")
@@ -983,6 +2291,7 @@ EMSCRIPTEN_BINDINGS(my_module) {
         .value("PARSING", webifc::utility::LoaderErrorType::PARSING)
         .value("UNSPECIFIED", webifc::utility::LoaderErrorType::UNSPECIFIED)
         .value("UNSUPPORTED_TYPE", webifc::utility::LoaderErrorType::UNSUPPORTED_TYPE)
+        .value("DEGENERATE_GEOMETRY", webifc::utility::LoaderErrorType::DEGENERATE_GEOMETRY)
         ;
 
     emscripten::value_object<webifc::utility::LoaderError>("LoaderError")
@@ -1039,19 +2348,29 @@ EMSCRIPTEN_BINDINGS(my_module) {
     emscripten::function("LoadAllGeometry", &LoadAllGeometry);
     emscripten::function("GetAllAlignments", &GetAllAlignments);
     emscripten::function("OpenModel", &OpenModel);
+    emscripten::function("OpenModels", &OpenModels);
+    emscripten::function("OpenModelAndStreamMeshes", &OpenModelAndStreamMeshes);
     emscripten::function("CreateModel", &CreateModel);
     emscripten::function("GetMaxExpressID", &GetMaxExpressID);
     emscripten::function("CloseModel", &CloseModel);
     emscripten::function("GetModelSize", &GetModelSize);
     emscripten::function("IsModelOpen", &IsModelOpen);
     emscripten::function("GetGeometry", &GetGeometry);
+    emscripten::function("PinGeometry", &PinGeometry);
+    emscripten::function("GetPinnedGeometry", &GetPinnedGeometry);
+    emscripten::function("ReleaseGeometries", &ReleaseGeometries);
     emscripten::function("GetFlatMesh", &GetFlatMesh);
     emscripten::function("StreamMeshes", &StreamMeshes);
     emscripten::function("GetCoordinationMatrix", &GetCoordinationMatrix);
     emscripten::function("StreamAllMeshes", &StreamAllMeshes);
     emscripten::function("StreamAllMeshesWithTypes", &StreamAllMeshesWithTypesVal);
+    emscripten::function("StreamInstancedMeshes", &StreamInstancedMeshes);
+    emscripten::function("GetGeometryDeduplicationStats", &GetGeometryDeduplicationStats);
+    emscripten::function("GetSlowestBooleans", &GetSlowestBooleans);
     emscripten::function("GetAndClearErrors", &GetAndClearErrors);
     emscripten::function("GetLine", &GetLine);
+    emscripten::function("GetPropertySetsForElements", &GetPropertySetsForElements);
+    emscripten::function("GetSpatialTree", &GetSpatialTree);
     emscripten::function("GetLineType", &GetLineType);
     emscripten::function("GetHeaderLine", &GetHeaderLine);
     emscripten::function("WriteLine", &WriteLine);
@@ -1068,4 +2387,5 @@ EMSCRIPTEN_BINDINGS(my_module) {
     emscripten::function("GetTypeCodeFromName", &GetTypeCodeFromName);
     emscripten::function("IsIfcElement", &IsIfcElement);
     emscripten::function("GetVersion", &GetVersion);
+    emscripten::function("IsMultiThreaded", &IsMultiThreaded);
 }
@@ -6,6 +6,7 @@
 #include <iostream>
 #include <fstream>
 #include <filesystem>
+#include <chrono>
 #include "test/io_helpers.h"
 
 #include "parsing/IfcLoader.h"
@@ -178,6 +179,54 @@ void Benchmark()
     std::cout << std::endl;
 }
 
+// meshes the model with voids subtracted in disjoint batches and one at a time, walls with many openings show the difference
+void BoolBenchmark(webifc::parsing::IfcLoader &loader, webifc::utility::LoaderErrorHandler &errorHandler, webifc::schema::IfcSchemaManager &schemaManager, webifc::utility::LoaderSettings set)
+{
+    for (bool merge : {true, false})
+    {
+        set.BOOL_MERGE_OPERANDS = merge;
+        webifc::geometry::IfcGeometryProcessor geometryLoader(loader,errorHandler,schemaManager,set);
+
+        auto start = ms();
+        LoadAllTest(loader, geometryLoader);
+        auto time = ms() - start;
+        errorHandler.ClearErrors();
+
+        std::cout << (merge ? "Merged" : "Sequential") << " voids: geometry took " << time << "ms" << std::endl;
+        for (auto &timing : geometryLoader.GetSlowestBools())
+        {
+            std::cout << "  #" << timing.expressID << " " << timing.milliseconds << "ms " << timing.firstPoints << " / " << timing.secondPoints << " points" << std::endl;
+        }
+    }
+}
+
+// per triangle cost of AddFace, the innermost step of every tessellator, with and without a capacity hint
+void GeometryBuildBenchmark()
+{
+    const uint32_t NUM_TRIANGLES = 1000000;
+
+    for (bool reserve : {false, true})
+    {
+        webifc::geometry::IfcGeometry geom;
+        if (reserve)
+        {
+            geom.Reserve(NUM_TRIANGLES * 3, NUM_TRIANGLES);
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < NUM_TRIANGLES; i++)
+        {
+            double x = i;
+            geom.AddFace(glm::dvec3(x, 0, 0), glm::dvec3(x + 1, 0, 0), glm::dvec3(x, 1, 0));
+        }
+        double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+        std::cout << (reserve ? "Reserved" : "Unreserved") << " AddFace: " << ns / NUM_TRIANGLES << " ns per triangle" << std::endl;
+    }
+
+    std::cout << "NaN points: " << webifc::geometry::IfcGeometry::degenerateInput.nanPoints << ", zero area faces: " << webifc::geometry::IfcGeometry::degenerateInput.zeroAreaFaces << std::endl;
+}
+
 void TestTriangleDecompose()
 {
     const int NUM_TESTS = 100;
@@ -260,6 +309,10 @@ int main()
 
     // return 0;
 
+    // GeometryBuildBenchmark();
+
+    // return 0;
+
     // std::string content = ReadFile("C:/Users/qmoya/Desktop/PROGRAMES/VSCODE/IFC.JS/issues/#bool testing/problematics/Projekt_COLORADO_PS.ifc");
     // std::string content = ReadFile("C:/Users/qmoya/Desktop/PROGRAMES/VSCODE/IFC.JS/issues/#bool testing/problematics/Sample1_Vectorworks2022.ifc");
     // std::string content = ReadFile("C:/Users/qmoya/Desktop/PROGRAMES/VSCODE/IFC.JS/issues/#bool testing/problematics/S_Office_Integrated Design Archi.ifc");
@@ -291,11 +344,15 @@ int main()
 
     std::cout << "Reading took " << time << "ms" << std::endl;
 
+    // BoolBenchmark(loader, errorHandler, schemaManager, set);
+
+    // return 0;
+
     // std::ofstream outputFile("output.ifc");
     // outputFile << loader.DumpSingleObjectAsIFC(14363);
     // outputFile.close();
 
-    webifc::geometry::IfcGeometryProcessor geometryLoader(loader,errorHandler,schemaManager,set.CIRCLE_SEGMENTS_HIGH,set.COORDINATE_TO_ORIGIN);
+    webifc::geometry::IfcGeometryProcessor geometryLoader(loader,errorHandler,schemaManager,set);
 
     start = ms();
     // SpecificLoadTest(loader, geometryLoader, 8765);
@@ -52,6 +52,11 @@ export const SET_BEGIN = 7;
 export const SET_END = 8;
 export const LINE_END = 9;
 
+// vertex layouts for LoaderSettings.VERTEX_FORMAT
+export const VERTEX_FLOAT = 0; // float32 position and normal, 24 bytes
+export const VERTEX_FLOAT_OCT = 1; // float32 position, snorm16 octahedral normal, 16 bytes
+export const VERTEX_QUANTIZED_OCT = 2; // unorm16 position and padding, snorm16 octahedral normal, 12 bytes
+
 /**
  * Settings for the IFCLoader
  * @property {boolean} COORDINATE_TO_ORIGIN - If true, the model will be translated to the origin.
@@ -59,9 +64,23 @@ export const LINE_END = 9;
  * @property {number} CIRCLE_SEGMENTS_LOW - Number of segments for low quality circles.
  * @property {number} CIRCLE_SEGMENTS_MEDIUM - Number of segments for medium quality circles.
  * @property {number} CIRCLE_SEGMENTS_HIGH - Number of segments for high quality circles.
- * @property {number} BOOL_ABORT_THRESHOLD - Threshold for aborting boolean operations.
+ * @property {number} CURVE_MAX_DEVIATION - Metres a chord may stray from its circle, arc, ellipse or B-spline curve, or a triangle from its B-spline surface, e.g. 0.002. With CURVE_MAX_ANGLE also 0 every circle gets CIRCLE_SEGMENTS_HIGH points.
+ * @property {number} CURVE_MAX_ANGLE - Degrees a single curve segment may turn, e.g. 15. 0 does not limit it.
+ * @property {number} CURVE_MIN_SEGMENTS - Fewest segments of a full circle when the tolerances are set, arcs get their share.
+ * @property {number} CURVE_MAX_SEGMENTS - Most segments of a full circle or B-spline curve when the tolerances are set, arcs get their share.
+ * @property {number} BOOL_ABORT_THRESHOLD - Combined point count of two operands above which a boolean subtraction is skipped, e.g. 10000, 0 (the default) disables it.
+ * @property {number} BOOL_TIME_BUDGET - Milliseconds of boolean operations per element, past it the element keeps its unsubtracted geometry, 0 disables it.
+ * @property {boolean} BOOL_MERGE_OPERANDS - If true, voids whose bounding boxes don't overlap are subtracted in a single boolean, false (the default) subtracts them one at a time. Try it on models with walls of many openings, see BoolBenchmark in web-ifc-test.
+ * @property {number} CREASE_ANGLE - Angle in degrees between face normals below which triangulated face sets share vertices and smooth their normals.
+ * @property {number} VERTEX_FORMAT - Layout of the geometry vertex data, one of VERTEX_FLOAT, VERTEX_FLOAT_OCT or VERTEX_QUANTIZED_OCT. GetVertexDataSize counts 4 byte words.
+ * @property {boolean} KEEP_DOUBLE_VERTICES - If false, the double precision vertices of delivered geometries are freed once their vertex data is built.
  * @property {number} MEMORY_LIMIT - Memory limit for the loader.
  * @property {number} TAPE_SIZE - Size of the tape for the loader.
+ * @property {number} GEOMETRY_CACHE_SIZE - Bytes of mapped representation geometry kept between elements, 0 disables the cache. The element workers of the multi-threaded build share it equally.
+ * @property {number} GEOMETRY_DEDUPLICATION_TOLERANCE - Distance within which the vertices of geometries shared in instanced streaming must agree, 0 disables deduplication.
+ * @property {number} GEOMETRY_THREADS - Threads meshing elements in the multi-threaded build, 0 uses all cores, more than the core count are capped to it.
+ * @property {boolean} STREAM_IN_ORDER - With several geometry threads, false delivers meshes as they complete instead of in element order.
+ * @property {number} BREP_PARALLEL_FACES - Shells with at least this many faces are triangulated on GEOMETRY_THREADS threads when not meshed by the element workers, 0 disables it.
  */
 export interface LoaderSettings {
     COORDINATE_TO_ORIGIN?: boolean;
@@ -69,9 +88,23 @@ export interface LoaderSettings {
     CIRCLE_SEGMENTS_LOW?: number;
     CIRCLE_SEGMENTS_MEDIUM?: number;
     CIRCLE_SEGMENTS_HIGH?: number;
+    CURVE_MAX_DEVIATION?: number;
+    CURVE_MAX_ANGLE?: number;
+    CURVE_MIN_SEGMENTS?: number;
+    CURVE_MAX_SEGMENTS?: number;
     BOOL_ABORT_THRESHOLD?: number;
+    BOOL_TIME_BUDGET?: number;
+    BOOL_MERGE_OPERANDS?: boolean;
+    CREASE_ANGLE?: number;
+    VERTEX_FORMAT?: number;
+    KEEP_DOUBLE_VERTICES?: boolean;
     MEMORY_LIMIT?: number;
     TAPE_SIZE? : number;
+    GEOMETRY_CACHE_SIZE?: number;
+    GEOMETRY_DEDUPLICATION_TOLERANCE?: number;
+    GEOMETRY_THREADS?: number;
+    STREAM_IN_ORDER?: boolean;
+    BREP_PARALLEL_FACES?: number;
 }
 
 export interface Vector<T> {
@@ -134,6 +167,89 @@ export interface IfcGeometry {
     GetVertexDataSize(): number;
     GetIndexData(): number;
     GetIndexDataSize(): number;
+    /** maps VERTEX_QUANTIZED_OCT positions to geometry coordinates, column major */
+    GetDequantizationMatrix(): Array<number>;
+}
+
+/**
+ * Property sets of a list of elements flattened into columns, one row per (element, property set, property)
+ * @property {Array<string>} strings - property names and string values, referenced by index
+ * @property {Uint8Array} valueTypes - token type of the value (REAL, REF, STRING, ENUM or EMPTY)
+ * @property {Uint32Array} valueTypeCodes - IFC type wrapping the value (e.g. IFCLABEL) or the quantity type, 0 if none
+ * @property {Int32Array} stringValueIndices - index of string values into strings, -1 for other values
+ */
+export interface PropertySetTable {
+    elementIDs: Uint32Array;
+    psetIDs: Uint32Array;
+    propertyIDs: Uint32Array;
+    nameIndices: Uint32Array;
+    valueTypes: Uint8Array;
+    valueTypeCodes: Uint32Array;
+    numberValues: Float64Array;
+    stringValueIndices: Int32Array;
+    strings: Array<string>;
+}
+
+/**
+ * Spatial structure of a model as a flat depth-first list of nodes
+ * @property {Int32Array} parents - index of each node's parent in the same arrays, -1 for the IfcProject
+ */
+export interface SpatialTree {
+    expressIDs: Uint32Array;
+    types: Uint32Array;
+    parents: Int32Array;
+}
+
+/**
+ * Placements of shared geometries, one row per (element, geometry) pair
+ * @property {Float64Array} transforms - 16 column major values per row
+ * @property {Float64Array} colors - 4 values (r, g, b, a) per row
+ */
+export interface InstanceTable {
+    elementIDs: Uint32Array;
+    geometryIDs: Uint32Array;
+    transforms: Float64Array;
+    colors: Float64Array;
+}
+
+/**
+ * Outcome of the last instanced stream of a model
+ * @property {number} bytesSaved - size of the vertex and index buffers that were not streamed because of duplicates
+ */
+export interface GeometryDeduplicationStats {
+    uniqueGeometries: number;
+    duplicateGeometries: number;
+    bytesSaved: number;
+}
+
+/**
+ * Timing of one boolean subtraction
+ * @property {number} expressID - element or IfcBooleanResult the subtraction belongs to
+ * @property {boolean} aborted - true if BOOL_ABORT_THRESHOLD or BOOL_TIME_BUDGET skipped (part of) it
+ */
+export interface BooleanTiming {
+    expressID: number;
+    milliseconds: number;
+    firstPoints: number;
+    secondPoints: number;
+    aborted: boolean;
+}
+
+/**
+ * Geometry buffers pinned in the wasm heap, the arrays are views and are not copied
+ * @property {number} handle - pin handle, pass it to ReleaseGeometries once the data has been consumed
+ * @property {number} vertexFormat - VERTEX_FORMAT the vertex data was built in
+ * @property {Array<number>} dequantizationMatrix - maps VERTEX_QUANTIZED_OCT positions to geometry coordinates, column major
+ * @property {Float32Array} vertexData - float view of the vertex buffer, only the float32 fields of the format read correctly through it
+ * @property {Uint32Array} vertexWords - the same buffer as 4 byte words, read the packed 16 bit fields of VERTEX_FLOAT_OCT and VERTEX_QUANTIZED_OCT through it
+ */
+export interface PinnedGeometry {
+    handle: number;
+    vertexFormat: number;
+    dequantizationMatrix: Array<number>;
+    vertexData: Float32Array;
+    vertexWords: Uint32Array;
+    indexData: Uint32Array;
 }
 
 export interface ifcType {
@@ -204,41 +320,88 @@ export class IfcAPI {
 
      /**
      * Opens a set of models and returns model IDs 
+     * In the multi-threaded build the models are parsed in parallel
      * @param dataSets Array of Buffers containing IFC data (bytes)
      * @param settings Settings for loading the model @see LoaderSettings
 	 * @returns Array of model IDs
     */
     OpenModels(dataSets: Array<Uint8Array>, settings?: LoaderSettings): Array<number> {
-        let s: LoaderSettings = {
-            MEMORY_LIMIT :  3221225472,
-            ...settings
-        };
+        let s = this.CreateSettings(settings);
         s.MEMORY_LIMIT = s.MEMORY_LIMIT! / dataSets.length;
-        let modelIDs:Array<number> = [];
 
-        for (let dataSet of dataSets) modelIDs.push(this.OpenModel(dataSet,s));
-        return modelIDs
-    }
+        // without threads nothing is gained by staging the files, they are read from JS memory one model at a time
+        if (!this.wasmModule.IsMultiThreaded()) {
+            return dataSets.map(dataSet => this.OpenModel(dataSet, s));
+        }
 
+        // stage every file in the wasm heap so the loader threads can read them without calling back into JS, each model
+        // owns its buffer from then on, it is freed once the model is loaded unless evicted tape chunks must be reloaded from it
+        let dataPtrs: Array<number> = [];
+        let dataSizes: Array<number> = [];
+        for (let dataSet of dataSets) {
+            let ptr = this.wasmModule._malloc(dataSet.byteLength);
+            if (ptr === 0) {
+                for (let staged of dataPtrs) this.wasmModule._free(staged);
+                throw new Error(`OpenModels: out of memory staging ${dataSets.length} files in the wasm heap`);
+            }
+            this.wasmModule.HEAPU8.set(dataSet, ptr);
+            dataPtrs.push(ptr);
+            dataSizes.push(dataSet.byteLength);
+        }
+
+        let modelIDs: Array<number> = [];
+        let result = this.wasmModule.OpenModels(s, dataPtrs, dataSizes);
+        for (let i = 0; i < result.size(); i++) modelIDs.push(result.get(i));
+        result.delete();
+
+        for (let modelID of modelIDs) {
+            this.modelSchemaList[modelID] = SchemaNames.indexOf(this.GetHeaderLine(modelID, FILE_SCHEMA).arguments[0][0].value);
+            Log.info("Parsing Model using " + this.GetHeaderLine(modelID, FILE_SCHEMA).arguments[0][0].value + " Schema");
+        }
+        return modelIDs;
+    }
 
     /**
-     * Opens a model and returns a modelID number
-     * @param data Buffer containing IFC data (bytes)
+     * Fills in the default values of any loader setting that was not provided
      * @param settings Settings for loading the model @see LoaderSettings
-	 * @returns ModelID
-    */
-    OpenModel(data: Uint8Array, settings?: LoaderSettings): number {
-        let s: LoaderSettings = {
+     * @returns Complete settings object
+     */
+    private CreateSettings(settings?: LoaderSettings): LoaderSettings {
+        return {
             COORDINATE_TO_ORIGIN: false,
             USE_FAST_BOOLS: true, //TODO: This needs to be fixed in the future to rely on elalish/manifold
             CIRCLE_SEGMENTS_LOW: 5,
             CIRCLE_SEGMENTS_MEDIUM: 8,
             CIRCLE_SEGMENTS_HIGH: 12,
-            BOOL_ABORT_THRESHOLD: 10000,
+            CURVE_MAX_DEVIATION: 0,
+            CURVE_MAX_ANGLE: 0,
+            CURVE_MIN_SEGMENTS: 4,
+            CURVE_MAX_SEGMENTS: 256,
+            BOOL_ABORT_THRESHOLD: 0,
+            BOOL_TIME_BUDGET: 0,
+            BOOL_MERGE_OPERANDS: false,
+            CREASE_ANGLE: 30,
+            VERTEX_FORMAT: VERTEX_FLOAT,
+            KEEP_DOUBLE_VERTICES: true,
             TAPE_SIZE: 67108864,
             MEMORY_LIMIT: 3221225472,
+            GEOMETRY_CACHE_SIZE: 268435456,
+            GEOMETRY_DEDUPLICATION_TOLERANCE: 0,
+            GEOMETRY_THREADS: 0,
+            STREAM_IN_ORDER: true,
+            BREP_PARALLEL_FACES: 10000,
             ...settings
         };
+    }
+
+    /**
+     * Opens a model and returns a modelID number
+     * @param data Buffer containing IFC data (bytes)
+     * @param settings Settings for loading the model @see LoaderSettings
+	 * @returns ModelID
+    */
+    OpenModel(data: Uint8Array, settings?: LoaderSettings): number {
+        let s = this.CreateSettings(settings);
         let result = this.wasmModule.OpenModel(s, (destPtr: number, offsetInSrc: number, destSize: number) => {
             let srcSize = Math.min(data.byteLength - offsetInSrc, destSize);
             let dest = this.wasmModule.HEAPU8.subarray(destPtr, destPtr + srcSize);
@@ -251,6 +414,51 @@ export class IfcAPI {
         return result;
     }
 
+    /**
+     * Opens a model and streams its meshes while the file is still being parsed
+     * Elements are meshed as soon as everything they reference has been read, so the first meshes arrive before parsing
+     * finishes. Elements that gain openings, materials or styled items later in the file are streamed a second time. Progress is
+     * reported once per tape chunk, a smaller TAPE_SIZE gives finer grained progress.
+     * The callbacks must not close the model or write to it.
+     * @param data Buffer containing IFC data (bytes)
+     * @param meshCallback callback function receiving each mesh and the ID of the model being opened
+     * @param settings Settings for loading the model @see LoaderSettings
+     * @param progressCallback called with the model ID, bytes read and lines indexed so far, return false to cancel
+	 * @returns ModelID, or -1 if the load was cancelled, in which case the model is closed
+    */
+    OpenModelAndStreamMeshes(data: Uint8Array, meshCallback: (mesh: FlatMesh, modelID: number) => void, settings?: LoaderSettings,
+        progressCallback?: (modelID: number, bytesRead: number, linesIndexed: number) => boolean | void): number {
+        let s = this.CreateSettings(settings);
+        let registerSchema = (modelID: number) => {
+            if (this.modelSchemaList[modelID] !== undefined) return;
+            let schemaLine = this.GetHeaderLine(modelID, FILE_SCHEMA);
+            if (schemaLine === undefined) return;
+            this.modelSchemaList[modelID] = SchemaNames.indexOf(schemaLine.arguments[0][0].value);
+            Log.info("Parsing Model using " + schemaLine.arguments[0][0].value + " Schema");
+        };
+        let currentModelID = -1;
+        let result = this.wasmModule.OpenModelAndStreamMeshes(s, (destPtr: number, offsetInSrc: number, destSize: number) => {
+            let srcSize = Math.min(data.byteLength - offsetInSrc, destSize);
+            let dest = this.wasmModule.HEAPU8.subarray(destPtr, destPtr + srcSize);
+            let src = data.subarray(offsetInSrc, offsetInSrc + srcSize );
+            dest.set(src);
+            return srcSize;
+        }, (mesh: FlatMesh) => {
+            registerSchema(currentModelID);
+            meshCallback(mesh, currentModelID);
+        }, (modelID: number, bytesRead: number, linesIndexed: number) => {
+            if (currentModelID != modelID) {
+                // a fresh load may reuse the slot of a closed model
+                delete this.modelSchemaList[modelID];
+                currentModelID = modelID;
+            }
+            registerSchema(modelID);
+            return progressCallback ? progressCallback(modelID, bytesRead, linesIndexed) : true;
+        });
+        if (result >= 0) registerSchema(result);
+        return result;
+    }
+
     /**
      * Fetches the ifc schema version of a given model
      * @param modelID Model ID
@@ -266,17 +474,7 @@ export class IfcAPI {
 	 * @returns ModelID
     */
     CreateModel(model: NewIfcModel, settings?: LoaderSettings): number {
-        let s: LoaderSettings = {
-            COORDINATE_TO_ORIGIN: false,
-            USE_FAST_BOOLS: true, //TODO: This needs to be fixed in the future to rely on elalish/manifold
-            CIRCLE_SEGMENTS_LOW: 5,
-            CIRCLE_SEGMENTS_MEDIUM: 8,
-            CIRCLE_SEGMENTS_HIGH: 12,
-            BOOL_ABORT_THRESHOLD: 10000,
-            TAPE_SIZE: 67108864,
-            MEMORY_LIMIT: 3221225472,
-            ...settings
-        };
+        let s = this.CreateSettings(settings);
         let result = this.wasmModule.CreateModel(s);
         this.modelSchemaList[result] = SchemaNames.indexOf(model.schema);
         const modelName = model.name || "web-ifc-model-"+result+".ifc";
@@ -373,6 +571,25 @@ export class IfcAPI {
         return typesNames;
     }
 
+	/**
+	 * Gets the property sets and element quantities of many elements in a single call
+	 * @param modelID Model handle retrieved by OpenModel
+	 * @param elementIDs expressIDs of the elements
+	 * @returns packed table with one row per element, property set and property @see PropertySetTable
+	 */
+    GetPropertySetsForElements(modelID: number, elementIDs: Array<number>): PropertySetTable {
+        return this.wasmModule.GetPropertySetsForElements(modelID, elementIDs);
+    }
+
+	/**
+	 * Gets the whole spatial structure of a model (aggregation and containment) in a single call
+	 * @param modelID Model handle retrieved by OpenModel
+	 * @returns flat tree with parent indices @see SpatialTree
+	 */
+    GetSpatialTree(modelID: number): SpatialTree {
+        return this.wasmModule.GetSpatialTree(modelID);
+    }
+
 	/**
 	 * Gets the ifc line data for a given express ID
 	 * @param modelID Model handle retrieved by OpenModel
@@ -436,7 +653,7 @@ export class IfcAPI {
     }
 
     /**
-     * Returns the list of errors generated by the parser and clears it
+     * Returns the list of errors generated by the parser and the geometry processor, e.g. the degenerate input skipped while meshing an element, and clears it
      * @param modelID Model handle retrieved by OpenModel
      * @returns Vector containing the list of errors
      */
@@ -585,7 +802,7 @@ export class IfcAPI {
     }
 
     /**
-     * Writes a line in the model
+     * Writes a line in the model, refused while a multi-threaded mesh stream of the model is running
      * @param modelID Model handle retrieved by OpenModel
      * @param data RawLineData containing the ID, type and arguments of the line
      */
@@ -694,7 +911,52 @@ export class IfcAPI {
     }
 
     /**
-     * Closes a model and frees all related memory
+     * Pins the buffers of a geometry in the wasm heap and returns views on them without copying
+     * The buffers stay valid until released, even after the mesh has been streamed. The views are detached
+     * when the wasm heap grows, call GetPinnedGeometry to get fresh views of the same buffers.
+     * The buffers are moved, not copied, so GetGeometry returns the geometry empty until its element is meshed again.
+     * Pinning a geometry that a mesh places more than once returns the same handle, release it once.
+     * @param modelID Model handle retrieved by OpenModel
+     * @param geometryExpressID express ID of the geometry, as found in a FlatMesh
+     * @returns pinned vertex and index views @see PinnedGeometry
+     */
+    PinGeometry(modelID: number, geometryExpressID: number): PinnedGeometry {
+        return this.createPinnedViews(this.wasmModule.PinGeometry(modelID, geometryExpressID));
+    }
+
+    /**
+     * Returns fresh views of geometry buffers pinned by PinGeometry
+     * @param modelID Model handle retrieved by OpenModel
+     * @param handle pin handle returned by PinGeometry
+     */
+    GetPinnedGeometry(modelID: number, handle: number): PinnedGeometry | undefined {
+        let pinned = this.wasmModule.GetPinnedGeometry(modelID, handle);
+        return pinned === undefined ? undefined : this.createPinnedViews(pinned);
+    }
+
+    /**
+     * Frees pinned geometry buffers, views on them must not be used afterwards
+     * Closing the model releases all of its pinned geometries
+     * @param modelID Model handle retrieved by OpenModel
+     * @param handles one or more pin handles returned by PinGeometry
+     */
+    ReleaseGeometries(modelID: number, handles: number | Array<number>) {
+        this.wasmModule.ReleaseGeometries(modelID, Array.isArray(handles) ? handles : [handles]);
+    }
+
+    private createPinnedViews(pinned: any): PinnedGeometry {
+        return {
+            handle: pinned.handle,
+            vertexFormat: pinned.vertexFormat,
+            dequantizationMatrix: pinned.dequantizationMatrix,
+            vertexData: this.wasmModule.HEAPF32.subarray(pinned.vertexData / 4, pinned.vertexData / 4 + pinned.vertexDataSize),
+            vertexWords: this.wasmModule.HEAPU32.subarray(pinned.vertexData / 4, pinned.vertexData / 4 + pinned.vertexDataSize),
+            indexData: this.wasmModule.HEAPU32.subarray(pinned.indexData / 4, pinned.indexData / 4 + pinned.indexDataSize)
+        };
+    }
+
+    /**
+     * Closes a model and frees all related memory, refused while a multi-threaded mesh stream of the model is running
      * @param modelID Model handle retrieved by OpenModel, model must not be closed
     */
     CloseModel(modelID: number) {
@@ -704,6 +966,7 @@ export class IfcAPI {
 
 	/**
 	 * Streams all meshes of a model
+	 * In the multi-threaded build the callback runs while worker threads still read the model: CloseModel, WriteLine and WriteHeaderLine are refused until this returns.
 	 * @param modelID Model handle retrieved by OpenModel
 	 * @param meshCallback callback function that is called for each mesh
 	 */
@@ -713,6 +976,7 @@ export class IfcAPI {
 
 	/**
 	 * Streams all meshes of a model with a specific ifc type
+	 * In the multi-threaded build the callback runs while worker threads still read the model: CloseModel, WriteLine and WriteHeaderLine are refused until this returns.
 	 * @param modelID Model handle retrieved by OpenModel
 	 * @param types types of elements to stream
 	 * @param meshCallback callback function that is called for each mesh
@@ -721,6 +985,41 @@ export class IfcAPI {
         this.wasmModule.StreamAllMeshesWithTypes(modelID, types, meshCallback);
     }
 
+	/**
+	 * Streams the meshes of a model for instanced rendering, every distinct geometry is passed to the callback once
+	 * and all its placements are listed in the returned table. Occurrences of the same type (IfcMappedItem) share a geometry.
+	 * Faces of mirrored placements are not reversed, flip the winding when the determinant of the transform is negative.
+	 * Set GEOMETRY_DEDUPLICATION_TOLERANCE when opening the model to also share geometries with identical content.
+	 * In the multi-threaded build the callback runs while worker threads still read the model: CloseModel, WriteLine and WriteHeaderLine are refused until this returns.
+	 * @param modelID Model handle retrieved by OpenModel
+	 * @param geometryCallback callback function that is called once per geometry, the geometry is only valid during the call
+	 * @param types types of elements to stream, defaults to all element types streamed by StreamAllMeshes
+	 * @returns instance table @see InstanceTable
+	 */
+    StreamAllInstancedMeshes(modelID: number, geometryCallback: (geometryID: number, geometry: IfcGeometry) => void, types?: Array<number>): InstanceTable {
+        return this.wasmModule.StreamInstancedMeshes(modelID, types, (geometryID: number) => {
+            geometryCallback(geometryID, this.GetGeometry(modelID, geometryID));
+        });
+    }
+
+	/**
+	 * Gets the slowest boolean subtractions of the meshes generated so far, slowest first
+	 * @param modelID Model handle retrieved by OpenModel
+	 * @returns up to 32 timings @see BooleanTiming
+	 */
+    GetSlowestBooleans(modelID: number): Array<BooleanTiming> {
+        return this.wasmModule.GetSlowestBooleans(modelID);
+    }
+
+	/**
+	 * Gets how many geometries the last StreamAllInstancedMeshes call of a model shared by content
+	 * @param modelID Model handle retrieved by OpenModel
+	 * @returns deduplication stats @see GeometryDeduplicationStats
+	 */
+    GetGeometryDeduplicationStats(modelID: number): GeometryDeduplicationStats {
+        return this.wasmModule.GetGeometryDeduplicationStats(modelID);
+    }
+
     /**
      * Checks if a specific model ID is open or closed
      * @param modelID Model handle retrieved by OpenModel
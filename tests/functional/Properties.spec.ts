@@ -1,6 +1,6 @@
 import * as fs from 'fs';
 import * as path from 'path';
-import { IfcAPI, IFCRELASSOCIATESMATERIAL, IFCRELDEFINESBYPROPERTIES, IFCWALLSTANDARDCASE, LogLevel } from '../../dist/web-ifc-api-node.js';
+import { IfcAPI, IFCPROJECT, IFCRELASSOCIATESMATERIAL, IFCRELDEFINESBYPROPERTIES, IFCWALLSTANDARDCASE, LogLevel } from '../../dist/web-ifc-api-node.js';
 import type { Properties } from '../../dist/helpers/properties';
 
 declare global {
@@ -84,6 +84,20 @@ describe('Properties', () => {
         expect(HasProperties > 0).toBe(true);
     })
 
+    test('can get property sets of elements as a packed table', async () => {
+        const propertySets = await properties.getPropertySets(modelID, 9989);
+        const table = ifcApi.GetPropertySetsForElements(modelID, [9989]);
+        const expectedPsets = propertySets.map((pset: any) => pset.expressID).sort();
+        const expectedRows = propertySets.reduce((count: number, pset: any) => count + (pset.HasProperties ?? pset.Quantities).length, 0);
+        expect(Array.from(new Set(table.psetIDs)).sort()).toEqual(expectedPsets);
+        expect(table.elementIDs.length).toEqual(expectedRows);
+        expect(table.elementIDs.every((id: number) => id == 9989)).toBeTruthy();
+        for (let i = 0; i < table.propertyIDs.length; i++) {
+            const property = await properties.getItemProperties(modelID, table.propertyIDs[i]);
+            expect(table.strings[table.nameIndices[i]]).toEqual(property.Name.value);
+        }
+    })
+
     test('can get property materials on one given element', async () => {
         const propertyMaterials = await properties.getMaterialsProperties(modelID, 10258);
         expect(propertyMaterials[0]["Name"]["value"]).toEqual('Metal - Steel - 345 MPa');
@@ -117,6 +131,22 @@ describe('Properties', () => {
         expect(elements[0].hasOwnProperty("GlobalId")).toBeTruthy();
     })
 
+    test('can get the spatial tree as parent indices', async () => {
+        const tree = ifcApi.GetSpatialTree(modelID);
+        expect(tree.expressIDs[0]).toEqual(119);
+        expect(tree.parents[0]).toEqual(-1);
+        const site = tree.expressIDs.indexOf(148);
+        const building = tree.expressIDs.indexOf(129);
+        const storey = tree.expressIDs.indexOf(138);
+        expect(tree.parents[site]).toEqual(0);
+        expect(tree.parents[building]).toEqual(site);
+        expect(tree.parents[storey]).toEqual(building);
+        expect(tree.types[0]).toEqual(IFCPROJECT);
+        for (let i = 1; i < tree.parents.length; i++) expect(tree.parents[i]).toBeLessThan(i);
+        const contained = tree.parents.filter((parent: number) => parent == storey).length;
+        expect(contained).toBeGreaterThanOrEqual(46);
+    })
+
     test('can get all items of a given type', async () => {
         const IFCWALLSTANDARDCASEITEMS: any = await ifcApi.GetLineIDsWithType(modelID, IFCWALLSTANDARDCASE);
         expect(IFCWALLSTANDARDCASEITEMS.size()).toEqual(17);
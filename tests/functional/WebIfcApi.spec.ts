@@ -56,6 +56,25 @@ import type {
     RawLineData
 } from '../../dist/web-ifc-api-node.js';
 
+/**
+ * Signed volume enclosed by the geometries of an element, in the default vertex format.
+ */
+function MeshVolume(modelID: number, expressID: number) {
+    let flatMesh = ifcApi.GetFlatMesh(modelID, expressID);
+    let volume = 0;
+    for (let i = 0; i < flatMesh.geometries.size(); i++) {
+        let geometry = ifcApi.GetGeometry(modelID, flatMesh.geometries.get(i).geometryExpressID);
+        let vertices = ifcApi.GetVertexArray(geometry.GetVertexData(), geometry.GetVertexDataSize());
+        let indices = ifcApi.GetIndexArray(geometry.GetIndexData(), geometry.GetIndexDataSize());
+        for (let j = 0; j < indices.length; j += 3) {
+            let [a, b, c] = [indices[j] * 6, indices[j + 1] * 6, indices[j + 2] * 6];
+            volume += (vertices[a] * (vertices[b + 1] * vertices[c + 2] - vertices[b + 2] * vertices[c + 1])
+                - vertices[a + 1] * (vertices[b] * vertices[c + 2] - vertices[b + 2] * vertices[c])
+                + vertices[a + 2] * (vertices[b] * vertices[c + 1] - vertices[b + 1] * vertices[c])) / 6;
+        }
+    }
+    return volume;
+}
 
 let ifcApi: IfcAPI;
 let modelID: number;
@@ -262,6 +281,46 @@ describe('WebIfcApi geometries', () => {
         expect(geometryIndexDatasString).toEqual(expectedVertexAndIndexDatas.indexDatas);
         expect(geometryVertexArrayString).toEqual(expectedVertexAndIndexDatas.vertexDatas);
     })
+    test('can deliver quantized positions and octahedral normals', () => {
+        const exampleIFCData = fs.readFileSync(path.join(__dirname, '../artifacts/example.ifc.test'));
+        let compactModelID = ifcApi.OpenModel(exampleIFCData, { VERTEX_FORMAT: WebIFC.VERTEX_QUANTIZED_OCT, KEEP_DOUBLE_VERTICES: false });
+        let flatMesh = ifcApi.GetFlatMesh(compactModelID, geometries.get(expectedVertexAndIndexDatas.geometryIndex).expressID);
+        let geometry = ifcApi.GetGeometry(compactModelID, flatMesh.geometries.get(0).geometryExpressID);
+        let reference = expectedVertexAndIndexDatas.vertexDatas.split(",").map(Number);
+        let m = geometry.GetDequantizationMatrix();
+        expect(geometry.GetVertexDataSize()).toEqual(reference.length / 6 * 3);
+        let view = new DataView(ifcApi.wasmModule.HEAPU8.buffer, geometry.GetVertexData(), geometry.GetVertexDataSize() * 4);
+        for (let i = 0; i < reference.length / 6; i++) {
+            for (let j = 0; j < 3; j++) {
+                let position = view.getUint16(i * 12 + j * 2, true) * m[j * 5] + m[12 + j];
+                expect(Math.abs(position - reference[i * 6 + j])).toBeLessThanOrEqual(m[j * 5] + 1e-3);
+            }
+            let x = view.getInt16(i * 12 + 8, true) / 32767;
+            let y = view.getInt16(i * 12 + 10, true) / 32767;
+            let normal = [x, y, 1 - Math.abs(x) - Math.abs(y)];
+            if (normal[2] < 0) normal = [(1 - Math.abs(y)) * (x >= 0 ? 1 : -1), (1 - Math.abs(x)) * (y >= 0 ? 1 : -1), normal[2]];
+            let length = Math.hypot(normal[0], normal[1], normal[2]);
+            for (let j = 0; j < 3; j++) expect(Math.abs(normal[j] / length - reference[i * 6 + 3 + j])).toBeLessThan(1e-3);
+        }
+        ifcApi.CloseModel(compactModelID);
+    })
+    test('can pin geometry buffers and read them without copying', () => {
+        let flatMesh = ifcApi.GetFlatMesh(modelID, geometries.get(expectedVertexAndIndexDatas.geometryIndex).expressID);
+        let pinned = ifcApi.PinGeometry(modelID, flatMesh.geometries.get(0).geometryExpressID);
+        expect(pinned.vertexData.buffer).toBe(ifcApi.wasmModule.HEAPF32.buffer);
+        expect(pinned.indexData.join(",")).toEqual(expectedVertexAndIndexDatas.indexDatas);
+        expect(pinned.vertexData.join(",")).toEqual(expectedVertexAndIndexDatas.vertexDatas);
+        expect(pinned.vertexFormat).toEqual(WebIFC.VERTEX_FLOAT);
+        expect(pinned.vertexWords.byteOffset).toEqual(pinned.vertexData.byteOffset);
+        let placedAgain = ifcApi.PinGeometry(modelID, flatMesh.geometries.get(0).geometryExpressID);
+        expect(placedAgain.handle).toEqual(pinned.handle);
+        expect(placedAgain.indexData.join(",")).toEqual(expectedVertexAndIndexDatas.indexDatas);
+        ifcApi.StreamAllMeshes(modelID, () => {});
+        let again = ifcApi.GetPinnedGeometry(modelID, pinned.handle)!;
+        expect(again.indexData.join(",")).toEqual(expectedVertexAndIndexDatas.indexDatas);
+        ifcApi.ReleaseGeometries(modelID, pinned.handle);
+        expect(ifcApi.GetPinnedGeometry(modelID, pinned.handle)).toBeUndefined();
+    })
     test('can ensure the corret number of all streamed meshes ', () => {
         let count: number = 0;
         ifcApi.StreamAllMeshes(modelID, () => {
@@ -276,6 +335,282 @@ describe('WebIfcApi geometries', () => {
         });
         expect(count).toEqual(IFCEXTRUDEDAREASOLIDMeshesCount);
     })
+    test('streams the same meshes with the geometry cache disabled', () => {
+        const exampleIFCData = fs.readFileSync(path.join(__dirname, '../artifacts/example.ifc.test'));
+        let uncachedModelID = ifcApi.OpenModel(exampleIFCData, { GEOMETRY_CACHE_SIZE: 0 });
+        let collect = (id: number) => {
+            let sizes: string[] = [];
+            ifcApi.StreamAllMeshes(id, (mesh) => {
+                for (let i = 0; i < mesh.geometries.size(); i++) {
+                    let geometry = ifcApi.GetGeometry(id, mesh.geometries.get(i).geometryExpressID);
+                    sizes.push(mesh.expressID + ":" + geometry.GetVertexDataSize() + ":" + geometry.GetIndexDataSize());
+                }
+            });
+            return sizes;
+        };
+        expect(collect(uncachedModelID)).toEqual(collect(modelID));
+        ifcApi.CloseModel(uncachedModelID);
+    })
+    test('streams every element once when meshes are delivered as they complete', () => {
+        let expected: number[] = [];
+        ifcApi.StreamAllMeshes(modelID, (mesh) => { expected.push(mesh.expressID); });
+        const exampleIFCData = fs.readFileSync(path.join(__dirname, '../artifacts/example.ifc.test'));
+        let unorderedModelID = ifcApi.OpenModel(exampleIFCData, { GEOMETRY_THREADS: 2, STREAM_IN_ORDER: false });
+        let streamed: number[] = [];
+        ifcApi.StreamAllMeshes(unorderedModelID, (mesh) => { streamed.push(mesh.expressID); });
+        expect(streamed.sort()).toEqual(expected.sort());
+        ifcApi.CloseModel(unorderedModelID);
+    })
+    test('reports the slowest booleans slowest first', () => {
+        ifcApi.StreamAllMeshes(modelID, () => {});
+        let timings = ifcApi.GetSlowestBooleans(modelID);
+        expect(timings.length).toBeLessThanOrEqual(32);
+        for (let i = 1; i < timings.length; i++) expect(timings[i - 1].milliseconds).toBeGreaterThanOrEqual(timings[i].milliseconds);
+    })
+    test('keeps openings out of booleans above the abort threshold', () => {
+        const exampleIFCData = fs.readFileSync(path.join(__dirname, '../artifacts/example.ifc.test'));
+        let thresholdModelID = ifcApi.OpenModel(exampleIFCData, { BOOL_ABORT_THRESHOLD: 1 });
+        ifcApi.StreamAllMeshes(thresholdModelID, () => {});
+        let timings = ifcApi.GetSlowestBooleans(thresholdModelID);
+        expect(timings.length).toBeGreaterThan(0);
+        expect(timings.some(timing => timing.aborted)).toBe(true);
+        // an element whose openings were skipped keeps the material they cut out of it by default
+        let skipped = timings.find(timing => timing.aborted && ifcApi.IsIfcElement(ifcApi.GetLineType(thresholdModelID, timing.expressID)));
+        expect(skipped).toBeDefined();
+        expect(Math.abs(MeshVolume(thresholdModelID, skipped!.expressID))).toBeGreaterThan(Math.abs(MeshVolume(modelID, skipped!.expressID)));
+        ifcApi.CloseModel(thresholdModelID);
+    })
+    test('cuts a clipping result at its half space plane', () => {
+        // wall #12954 is a 4877.57 x 150 extrusion cut by a sloped plane, 880.37 high at one end and 1022.94 at the other
+        let volume = MeshVolume(modelID, 12954);
+        let expected = 4877.56541552208 * 150 * (880.372727305516 + 1022.94463024072) / 2;
+        expect(Math.abs(Math.abs(volume) - expected) / expected).toBeLessThan(1e-3);
+    })
+    test('shares the vertices of triangulated face sets within the crease angle', () => {
+        const cube = [
+            "ISO-10303-21;",
+            "HEADER;",
+            "FILE_DESCRIPTION(('ViewDefinition [ReferenceView]'),'2;1');",
+            "FILE_NAME('cube.ifc','2023-01-01T00:00:00',(''),(''),'','','');",
+            "FILE_SCHEMA(('IFC4'));",
+            "ENDSEC;",
+            "DATA;",
+            "#1=IFCCARTESIANPOINT((0.,0.,0.));",
+            "#2=IFCAXIS2PLACEMENT3D(#1,$,$);",
+            "#3=IFCLOCALPLACEMENT($,#2);",
+            "#4=IFCCARTESIANPOINTLIST3D(((0.,0.,0.),(1.,0.,0.),(1.,1.,0.),(0.,1.,0.),(0.,0.,1.),(1.,0.,1.),(1.,1.,1.),(0.,1.,1.)));",
+            "#5=IFCTRIANGULATEDFACESET(#4,$,.T.,((1,3,2),(1,4,3),(5,6,7),(5,7,8),(1,2,6),(1,6,5),(2,3,7),(2,7,6),(3,4,8),(3,8,7),(4,1,5),(4,5,8)),$);",
+            "#6=IFCSHAPEREPRESENTATION($,'Body','Tessellation',(#5));",
+            "#7=IFCPRODUCTDEFINITIONSHAPE($,$,(#6));",
+            "#8=IFCBUILDINGELEMENTPROXY('0000000000000000000001',$,'cube',$,$,#3,#7,$,$);",
+            "ENDSEC;",
+            "END-ISO-10303-21;"
+        ].join("\n");
+        let vertexCount = (settings: any) => {
+            let cubeModelID = ifcApi.OpenModel(new TextEncoder().encode(cube), settings);
+            let flatMesh = ifcApi.GetFlatMesh(cubeModelID, 8);
+            let geometry = ifcApi.GetGeometry(cubeModelID, flatMesh.geometries.get(0).geometryExpressID);
+            let count = geometry.GetVertexDataSize() / 6;
+            ifcApi.CloseModel(cubeModelID);
+            return count;
+        };
+        // three vertices per corner at right angles, one per corner once the crease angle takes them all
+        expect(vertexCount({})).toEqual(24);
+        expect(vertexCount({ CREASE_ANGLE: 180 })).toEqual(8);
+    })
+    test('samples circles by chord deviation when a curve tolerance is set', () => {
+        const rods = [
+            "ISO-10303-21;",
+            "HEADER;",
+            "FILE_DESCRIPTION(('ViewDefinition [ReferenceView]'),'2;1');",
+            "FILE_NAME('rods.ifc','2023-01-01T00:00:00',(''),(''),'','','');",
+            "FILE_SCHEMA(('IFC4'));",
+            "ENDSEC;",
+            "DATA;",
+            "#1=IFCCARTESIANPOINT((0.,0.,0.));",
+            "#2=IFCAXIS2PLACEMENT3D(#1,$,$);",
+            "#3=IFCLOCALPLACEMENT($,#2);",
+            "#4=IFCDIRECTION((0.,0.,1.));",
+            "#5=IFCCIRCLEPROFILEDEF(.AREA.,$,$,0.01);",
+            "#6=IFCEXTRUDEDAREASOLID(#5,#2,#4,1.);",
+            "#7=IFCSHAPEREPRESENTATION($,'Body','SweptSolid',(#6));",
+            "#8=IFCPRODUCTDEFINITIONSHAPE($,$,(#7));",
+            "#9=IFCBUILDINGELEMENTPROXY('0000000000000000000001',$,'bolt',$,$,#3,#8,$,$);",
+            "#10=IFCCIRCLEPROFILEDEF(.AREA.,$,$,20.);",
+            "#11=IFCEXTRUDEDAREASOLID(#10,#2,#4,1.);",
+            "#12=IFCSHAPEREPRESENTATION($,'Body','SweptSolid',(#11));",
+            "#13=IFCPRODUCTDEFINITIONSHAPE($,$,(#12));",
+            "#14=IFCBUILDINGELEMENTPROXY('0000000000000000000002',$,'tank',$,$,#3,#13,$,$);",
+            "ENDSEC;",
+            "END-ISO-10303-21;"
+        ].join("\n");
+        let vertexCounts = (settings: any) => {
+            let rodsModelID = ifcApi.OpenModel(new TextEncoder().encode(rods), settings);
+            let counts = [9, 14].map((expressID) => {
+                let flatMesh = ifcApi.GetFlatMesh(rodsModelID, expressID);
+                let geometry = ifcApi.GetGeometry(rodsModelID, flatMesh.geometries.get(0).geometryExpressID);
+                return geometry.GetVertexDataSize() / 6;
+            });
+            ifcApi.CloseModel(rodsModelID);
+            return counts;
+        };
+        let [fixedBolt, fixedTank] = vertexCounts({});
+        expect(fixedBolt).toEqual(fixedTank);
+        // a millimetre of deviation needs a handful of segments for the bolt and the segment limit for the tank
+        let [bolt, tank] = vertexCounts({ CURVE_MAX_DEVIATION: 0.001 });
+        expect(bolt).toBeLessThan(fixedBolt);
+        expect(tank).toBeGreaterThan(fixedTank);
+        expect(vertexCounts({ CURVE_MAX_DEVIATION: 0.001, CURVE_MAX_SEGMENTS: 64 })[1]).toBeLessThan(tank);
+    })
+    test('refines B-spline surfaces only where they bend and shares their vertices', () => {
+        const patches = [
+            "ISO-10303-21;",
+            "HEADER;",
+            "FILE_DESCRIPTION(('ViewDefinition [ReferenceView]'),'2;1');",
+            "FILE_NAME('patches.ifc','2023-01-01T00:00:00',(''),(''),'','','');",
+            "FILE_SCHEMA(('IFC4'));",
+            "ENDSEC;",
+            "DATA;",
+            "#1=IFCCARTESIANPOINT((0.,0.,0.));",
+            "#2=IFCAXIS2PLACEMENT3D(#1,$,$);",
+            "#3=IFCLOCALPLACEMENT($,#2);",
+            "#4=IFCCARTESIANPOINT((0.,1.,0.));",
+            "#5=IFCCARTESIANPOINT((1.,0.,0.));",
+            "#6=IFCCARTESIANPOINT((1.,1.,0.));",
+            "#7=IFCBSPLINESURFACEWITHKNOTS(1,1,((#1,#4),(#5,#6)),.UNSPECIFIED.,.F.,.F.,.F.,(2,2),(2,2),(0.,1.),(0.,1.),.UNSPECIFIED.);",
+            "#8=IFCPOLYLOOP((#1,#5,#6,#4));",
+            "#9=IFCFACEOUTERBOUND(#8,.T.);",
+            "#10=IFCADVANCEDFACE((#9),#7,.T.);",
+            "#11=IFCCLOSEDSHELL((#10));",
+            "#12=IFCADVANCEDBREP(#11);",
+            "#13=IFCSHAPEREPRESENTATION($,'Body','AdvancedBrep',(#12));",
+            "#14=IFCPRODUCTDEFINITIONSHAPE($,$,(#13));",
+            "#15=IFCBUILDINGELEMENTPROXY('0000000000000000000001',$,'flat',$,$,#3,#14,$,$);",
+            "#16=IFCCARTESIANPOINT((1.,0.,1.));",
+            "#17=IFCCARTESIANPOINT((1.,1.,1.));",
+            "#18=IFCCARTESIANPOINT((2.,0.,0.));",
+            "#19=IFCCARTESIANPOINT((2.,1.,0.));",
+            "#20=IFCBSPLINESURFACEWITHKNOTS(2,1,((#1,#4),(#16,#17),(#18,#19)),.UNSPECIFIED.,.F.,.F.,.F.,(3,3),(2,2),(0.,1.),(0.,1.),.UNSPECIFIED.);",
+            "#21=IFCPOLYLOOP((#1,#18,#19,#4));",
+            "#22=IFCFACEOUTERBOUND(#21,.T.);",
+            "#23=IFCADVANCEDFACE((#22),#20,.T.);",
+            "#24=IFCCLOSEDSHELL((#23));",
+            "#25=IFCADVANCEDBREP(#24);",
+            "#26=IFCSHAPEREPRESENTATION($,'Body','AdvancedBrep',(#25));",
+            "#27=IFCPRODUCTDEFINITIONSHAPE($,$,(#26));",
+            "#28=IFCBUILDINGELEMENTPROXY('0000000000000000000002',$,'arch',$,$,#3,#27,$,$);",
+            "ENDSEC;",
+            "END-ISO-10303-21;"
+        ].join("\n");
+        let patchesModelID = ifcApi.OpenModel(new TextEncoder().encode(patches));
+        let counts = [15, 28].map((expressID) => {
+            let flatMesh = ifcApi.GetFlatMesh(patchesModelID, expressID);
+            let geometry = ifcApi.GetGeometry(patchesModelID, flatMesh.geometries.get(0).geometryExpressID);
+            return { vertices: geometry.GetVertexDataSize() / 6, triangles: geometry.GetIndexDataSize() / 3 };
+        });
+        ifcApi.CloseModel(patchesModelID);
+        expect(counts[0]).toEqual({ vertices: 4, triangles: 2 });
+        expect(counts[1].triangles).toBeGreaterThan(2);
+        expect(counts[1].vertices).toBeLessThan(counts[1].triangles);
+    })
+    test('splits concave quads at their reflex corner and leaves concave polygons to earcut', () => {
+        const faces = [
+            "ISO-10303-21;",
+            "HEADER;",
+            "FILE_DESCRIPTION(('ViewDefinition [ReferenceView]'),'2;1');",
+            "FILE_NAME('faces.ifc','2023-01-01T00:00:00',(''),(''),'','','');",
+            "FILE_SCHEMA(('IFC4'));",
+            "ENDSEC;",
+            "DATA;",
+            "#1=IFCCARTESIANPOINT((0.,0.,0.));",
+            "#2=IFCAXIS2PLACEMENT3D(#1,$,$);",
+            "#3=IFCLOCALPLACEMENT($,#2);",
+            "#4=IFCCARTESIANPOINT((2.,1.,0.));",
+            "#5=IFCCARTESIANPOINT((0.,2.,0.));",
+            "#6=IFCCARTESIANPOINT((1.,1.,0.));",
+            "#7=IFCPOLYLOOP((#1,#4,#5,#6));",
+            "#8=IFCFACEOUTERBOUND(#7,.T.);",
+            "#9=IFCFACE((#8));",
+            "#10=IFCCLOSEDSHELL((#9));",
+            "#11=IFCFACETEDBREP(#10);",
+            "#12=IFCSHAPEREPRESENTATION($,'Body','Brep',(#11));",
+            "#13=IFCPRODUCTDEFINITIONSHAPE($,$,(#12));",
+            "#14=IFCBUILDINGELEMENTPROXY('0000000000000000000001',$,'dart',$,$,#3,#13,$,$);",
+            "#15=IFCCARTESIANPOINT((2.,0.,0.));",
+            "#16=IFCCARTESIANPOINT((1.,2.,0.));",
+            "#17=IFCPOLYLOOP((#1,#15,#4,#6,#16,#5));",
+            "#18=IFCFACEOUTERBOUND(#17,.T.);",
+            "#19=IFCFACE((#18));",
+            "#20=IFCCLOSEDSHELL((#19));",
+            "#21=IFCFACETEDBREP(#20);",
+            "#22=IFCSHAPEREPRESENTATION($,'Body','Brep',(#21));",
+            "#23=IFCPRODUCTDEFINITIONSHAPE($,$,(#22));",
+            "#24=IFCBUILDINGELEMENTPROXY('0000000000000000000002',$,'ell',$,$,#3,#23,$,$);",
+            "ENDSEC;",
+            "END-ISO-10303-21;"
+        ].join("\n");
+        let facesModelID = ifcApi.OpenModel(new TextEncoder().encode(faces));
+        let meshed = [14, 24].map((expressID) => {
+            let flatMesh = ifcApi.GetFlatMesh(facesModelID, expressID);
+            let geometry = ifcApi.GetGeometry(facesModelID, flatMesh.geometries.get(0).geometryExpressID);
+            let vertices = ifcApi.GetVertexArray(geometry.GetVertexData(), geometry.GetVertexDataSize());
+            let indices = ifcApi.GetIndexArray(geometry.GetIndexData(), geometry.GetIndexDataSize());
+            // a wrong diagonal covers more than the face, so the triangles only add up to its area when they stay inside it
+            let area = 0;
+            for (let i = 0; i < indices.length; i += 3) {
+                let [a, b, c] = [indices[i], indices[i + 1], indices[i + 2]].map((index) => [vertices[index * 6], vertices[index * 6 + 1]]);
+                area += Math.abs((b[0] - a[0]) * (c[1] - a[1]) - (b[1] - a[1]) * (c[0] - a[0])) / 2;
+            }
+            return { triangles: indices.length / 3, area: area };
+        });
+        ifcApi.CloseModel(facesModelID);
+        expect(meshed[0].triangles).toEqual(2);
+        expect(meshed[0].area).toBeCloseTo(1);
+        expect(meshed[1].triangles).toEqual(4);
+        expect(meshed[1].area).toBeCloseTo(3);
+    })
+    test('meshes the same elements with merged and sequential voids', () => {
+        const exampleIFCData = fs.readFileSync(path.join(__dirname, '../artifacts/example.ifc.test'));
+        let meshed = (settings: any) => {
+            let boolModelID = ifcApi.OpenModel(exampleIFCData, settings);
+            let geometries = new Map<number, number>();
+            ifcApi.StreamAllMeshes(boolModelID, (mesh) => {
+                geometries.set(mesh.expressID, mesh.geometries.size());
+            });
+            ifcApi.CloseModel(boolModelID);
+            return geometries;
+        };
+        expect(meshed({ BOOL_MERGE_OPERANDS: true })).toEqual(meshed({ BOOL_MERGE_OPERANDS: false }));
+    })
+    test('can stream instanced meshes with one row per placement', () => {
+        let placements = 0;
+        ifcApi.StreamAllMeshes(modelID, (mesh) => {
+            placements += mesh.geometries.size();
+        });
+        let geometryIDs: number[] = [];
+        let table = ifcApi.StreamAllInstancedMeshes(modelID, (geometryID, geometry) => {
+            expect(geometry.GetVertexDataSize()).toBeGreaterThan(0);
+            geometryIDs.push(geometryID);
+        });
+        expect(table.elementIDs.length).toEqual(placements);
+        expect(table.transforms.length).toEqual(placements * 16);
+        expect(table.colors.length).toEqual(placements * 4);
+        expect(new Set(geometryIDs).size).toEqual(geometryIDs.length);
+        expect(new Set(table.geometryIDs)).toEqual(new Set(geometryIDs));
+    })
+    test('can deduplicate identical geometries by content', () => {
+        let geometries = new Set(ifcApi.StreamAllInstancedMeshes(modelID, () => {}).geometryIDs).size;
+        const exampleIFCData = fs.readFileSync(path.join(__dirname, '../artifacts/example.ifc.test'));
+        let dedupModelID = ifcApi.OpenModel(exampleIFCData, { GEOMETRY_DEDUPLICATION_TOLERANCE: 1e-6 });
+        let streamed = 0;
+        let table = ifcApi.StreamAllInstancedMeshes(dedupModelID, () => { streamed++; });
+        let stats = ifcApi.GetGeometryDeduplicationStats(dedupModelID);
+        expect(stats.uniqueGeometries).toEqual(streamed);
+        expect(stats.uniqueGeometries + stats.duplicateGeometries).toEqual(geometries);
+        expect(new Set(table.geometryIDs).size).toEqual(streamed);
+        expect(stats.bytesSaved > 0).toEqual(stats.duplicateGeometries > 0);
+        ifcApi.CloseModel(dedupModelID);
+    })
 });
 
 describe('WebIfcApi geometry transformation', () => {
@@ -335,6 +670,19 @@ describe('WebIfcApi writing methods', () => {
         let project: any = ifcApi.GetLine(emptyFileModelID, 1); 
         expect(project.Name.value).toEqual("foo");
     })
+    test('Can move an element by writing its placement point', () => {
+        let elementID = geometries.get(4).expressID;
+        let before = ifcApi.GetFlatMesh(tmpModelID, elementID).geometries.get(0).flatTransformation;
+        let element: any = ifcApi.GetLine(tmpModelID, elementID);
+        let placement: any = ifcApi.GetLine(tmpModelID, element.ObjectPlacement.value);
+        let axis: any = ifcApi.GetLine(tmpModelID, placement.RelativePlacement.value);
+        let point: any = ifcApi.GetLine(tmpModelID, axis.Location.value);
+        point.Coordinates[2].value = Number(point.Coordinates[2].value) + 1000;
+        ifcApi.WriteLine(tmpModelID, point);
+        let after = ifcApi.GetFlatMesh(tmpModelID, elementID).geometries.get(0).flatTransformation;
+        let moved = Math.abs(after[12] - before[12]) + Math.abs(after[13] - before[13]) + Math.abs(after[14] - before[14]);
+        expect(moved).toBeGreaterThan(1);
+    })
     test('Can modify a line with a rawLineData', () => {
         ifcApi.WriteRawLineData(emptyFileModelID, {
             ID: 1,
@@ -411,6 +759,30 @@ describe('WebIfcApi writing methods', () => {
         expect(line.expressID).toEqual(expressId);
     })
 
+    test('reads numbers written without a point as REAL and saves them as written', () => {
+        const numbers = [
+            "ISO-10303-21;",
+            "HEADER;",
+            "FILE_DESCRIPTION(('ViewDefinition [ReferenceView]'),'2;1');",
+            "FILE_NAME('numbers.ifc','2023-01-01T00:00:00',(''),(''),'','','');",
+            "FILE_SCHEMA(('IFC4'));",
+            "ENDSEC;",
+            "DATA;",
+            "#1=IFCCARTESIANPOINT((1,-2,123456789));",
+            "#2=IFCCARTESIANPOINT((0.5,2.,1.E3));",
+            "ENDSEC;",
+            "END-ISO-10303-21;"
+        ].join("\n");
+        let numbersModelID = ifcApi.OpenModel(new TextEncoder().encode(numbers));
+        let coordinates = [1, 2].map((id) => ifcApi.GetRawLineData(numbersModelID, id).arguments[0]);
+        expect(coordinates.map((point: any) => point.map((value: any) => value.type))).toEqual([[WebIFC.REAL, WebIFC.REAL, WebIFC.REAL], [WebIFC.REAL, WebIFC.REAL, WebIFC.REAL]]);
+        expect(coordinates.map((point: any) => point.map((value: any) => Number(value.value)))).toEqual([[1, -2, 123456789], [0.5, 2, 1000]]);
+        let saved = Utf8ArrayToStr(ifcApi.SaveModel(numbersModelID));
+        ifcApi.CloseModel(numbersModelID);
+        expect(saved).toContain("#1=IFCCARTESIANPOINT((1,-2,123456789));");
+        expect(saved).toContain("#2=IFCCARTESIANPOINT((0.5,2.,1000.));");
+    })
+
 });
 
 describe('WebIfcApi known failures', () => {
@@ -527,7 +899,8 @@ describe('creating ifc', () => {
 
     test('can create & save new ifc model', () => {
         let createdID = ifcApi.CreateModel({schema: WebIFC.Schemas.IFC2X3});
-        expect(createdID).toBe(6);
+        // the slot of the model closed in the previous test is reused
+        expect(createdID).toBe(5);
         const buffer = ifcApi.SaveModel(createdID);
         fs.writeFileSync(path.join(__dirname, '../artifacts/created.ifc'), buffer);
         ifcApi.CloseModel(createdID);
@@ -562,7 +935,7 @@ describe('opening large amounts of data', () => {
         };
         const exampleIFCData = fs.readFileSync(path.join(__dirname, '../artifacts/S_Office_Integrated Design Archi.ifc.test'));
         let modelId = ifcApi.OpenModel(exampleIFCData,s);
-        expect(modelId).toBe(7);
+        expect(modelId).toBe(5);
     });
 
      test("open a small model but many times", () => {
@@ -574,6 +947,55 @@ describe('opening large amounts of data', () => {
         for (let i=0; i < 100; i++) exampleIFCDatas.push(exampleIFCData); 
         let modelIds = ifcApi.OpenModels(exampleIFCDatas,s);
         expect(modelIds.length).toBe(100);
+        expect(new Set(modelIds).size).toBe(100);
+        for (let id of modelIds) expect(ifcApi.GetLineIDsWithType(id, WebIFC.IFCBUILDINGSTOREY).size()).toBe(2);
+    });
+
+    test("closed model slots are reused", () => {
+        const exampleIFCData = fs.readFileSync(path.join(__dirname, '../artifacts/example.ifc.test'));
+        let firstID = ifcApi.OpenModel(exampleIFCData);
+        ifcApi.CloseModel(firstID);
+        expect(ifcApi.IsModelOpen(firstID)).toBeFalsy();
+        let secondID = ifcApi.OpenModel(exampleIFCData);
+        expect(secondID).toBe(firstID);
+        expect(ifcApi.IsModelOpen(secondID)).toBeTruthy();
+        ifcApi.CloseModel(secondID);
+    });
+
+    test("can stream meshes while the model is being opened", () => {
+        let s: LoaderSettings = {
+            TAPE_SIZE : 104857
+        };
+        const exampleIFCData = fs.readFileSync(path.join(__dirname, '../artifacts/example.ifc.test'));
+        let progressCalls = 0;
+        let firstMeshAtProgress = -1;
+        let streamedIDs = new Set<number>();
+        let streamedModelID = -1;
+        let openedID = ifcApi.OpenModelAndStreamMeshes(exampleIFCData, (mesh: FlatMesh, id: number) => {
+            if (firstMeshAtProgress < 0) firstMeshAtProgress = progressCalls;
+            streamedIDs.add(mesh.expressID);
+            streamedModelID = id;
+        }, s, () => { progressCalls++; });
+        expect(progressCalls).toBeGreaterThan(1);
+        expect(firstMeshAtProgress).toBeLessThan(progressCalls);
+        expect(streamedModelID).toBe(openedID);
+        expect(streamedIDs.size).toBe(meshesCount);
+        expect(ifcApi.GetModelSchema(openedID)).toBe(expectedFileSchema);
+        ifcApi.CloseModel(openedID);
+    });
+
+    test("can cancel a model while it is being opened", () => {
+        let s: LoaderSettings = {
+            TAPE_SIZE : 104857
+        };
+        const exampleIFCData = fs.readFileSync(path.join(__dirname, '../artifacts/example.ifc.test'));
+        let cancelledID = -1;
+        let result = ifcApi.OpenModelAndStreamMeshes(exampleIFCData, () => {}, s, (id: number) => {
+            cancelledID = id;
+            return false;
+        });
+        expect(result).toBe(-1);
+        expect(ifcApi.IsModelOpen(cancelledID)).toBeFalsy();
     });
     
 })